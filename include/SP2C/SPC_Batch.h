@@ -0,0 +1,40 @@
+#pragma once
+#ifndef __SPC_BATCH__
+#define __SPC_BATCH__
+
+#include <SP2C/SPC_Vector.h>
+#include <SP2C/SPC_Shapes.h>
+#include <SP2C/SPC_Mat23.h>
+#include <SP2C/SPC_SIMD.h>
+
+namespace SP2C
+{
+	//points[i] = transform * points[i] for a contiguous array, SIMD::WIDTH points at a time. same results as the scalar product
+	void TransformPoints(const SPC_Mat23& transform, Vec2* points, unsigned int count);
+
+	//same without the translation. normals of a rigid transform (rotation and translation) are turned by this instead of
+	//being computed again from the faces. other transforms don't keep them unit length
+	void TransformVectors(const SPC_Mat23& transform, Vec2* vectors, unsigned int count);
+
+	//one transform per polygon of a vertex pool like the one of SPC_World: polygon k is count[k] vertices from start[k].
+	//normals can be nullptr. rigid transforms only, as in TransformVectors
+	void TransformPolygons(const SPC_Mat23* transforms, const unsigned int* start, const unsigned int* count, int polygons, Vec2* vertices, Vec2* normals);
+
+	namespace Collision
+	{
+		//one shape against many, with the other shapes given as arrays of their components (like the arrays of SPC_World).
+		//SIMD::WIDTH shapes are tested at once. bit i % 32 of mask[i / 32] is set when shape i collides,
+		//and every word of the mask up to (count + 31) / 32 is written
+
+		//same results as Circle_to_Circle(SPC_Manifold*) with a as A and circle i as B. returns the number of collisions.
+		//normals, penetrations and points can be nullptr. otherwise element i is written for each colliding circle i, and only for them
+		int Circle_to_Circles(const SPC_Circle& a, const Real* x, const Real* y, const Real* radius, int count, unsigned int* mask,
+			Vec2* normals = nullptr, Real* penetrations = nullptr, Vec2* points = nullptr);
+
+		//same test as AABB_to_AABB(SPC_AABB&, SPC_AABB&) between (min, max) and each box i, without branches. returns the number of overlaps
+		int AABB_to_AABBs(Vec2 min, Vec2 max, const Real* minX, const Real* minY, const Real* maxX, const Real* maxY, int count, unsigned int* mask);
+
+		int AABB_to_AABBs(const SPC_AABB& a, const Real* minX, const Real* minY, const Real* maxX, const Real* maxY, int count, unsigned int* mask);
+	}
+}
+#endif
\ No newline at end of file
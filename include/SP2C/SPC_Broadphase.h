@@ -0,0 +1,22 @@
+#pragma once
+#ifndef __SPC_BROADPHASE__
+#define __SPC_BROADPHASE__
+
+#include <SP2C/SPC_Shapes.h>
+#include <SP2C/SPC_Manifold.h>
+
+namespace SP2C
+{
+	const int SPC_NULL_PROXY = -1;
+
+	//called for each potential pair. A and B of the manifold are set, so it can be passed to Collision::Collide directly
+	typedef void (*SPC_PairCallback) (SPC_Manifold* pair, void* data);
+
+	//called for each proxy overlapping the query aabb. return false to stop the query
+	typedef bool (*SPC_QueryCallback) (int proxyId, SPC_Shape* shape, void* data);
+
+	//called for each proxy whose aabb the ray crosses before maxT. returns the new maxT of the ray:
+	//0 stops the cast, the t of a hit skips the proxies behind it, and maxT goes on unchanged
+	typedef Real (*SPC_RayCallback) (int proxyId, SPC_Shape* shape, Real maxT, void* data);
+}
+#endif
\ No newline at end of file
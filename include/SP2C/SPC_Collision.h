@@ -3,63 +3,427 @@
 #define __SPC_COLLISION__
 
 #include <algorithm>
+#include <type_traits>
+#include <variant>
 #include <SP2C/SPC_Vector.h>
 #include <SP2C/SPC_Math.h>
 #include <SP2C/SPC_Shapes.h>
 #include <SP2C/SPC_Manifold.h>
+#include <SP2C/SPC_Transform.h>
 
 namespace SP2C
 {
+	struct SPC_ThreadPool;
+
+	//face which separated (or least penetrated) a polygon pair in the last test. tested first in the next one,
+	//so a pair which is still apart costs one projection instead of a scan over every face
+	struct SPC_SATCache
+	{
+		unsigned int face;
+		unsigned char shape; //0 when the face is of A, 1 of B
+		bool valid;
+
+		SPC_SATCache();
+	};
+
+	struct SPC_RaycastHit
+	{
+		SPC_Shape* shape;
+		int proxyId; //proxy of the shape when the ray was cast through a broadphase
+		Real t; //the hit point is origin + t * dir
+		Vec2 point;
+		Vec2 normal; //normal of the surface at the hit point
+		int face; //face of the polygon, or of the aabb in the order of AABB_normals. -1 for circles
+	};
+
+	enum SPC_RaycastMode
+	{
+		RaycastClosest = 0, //the closest hit only
+		RaycastAny, //the first hit found. cheapest, for line of sight tests
+		RaycastAll //every hit, in no particular order
+	};
+
+	//how much of the manifold a narrowphase query computes. each level skips the work of the ones above it
+	enum SPC_QueryLevel
+	{
+		QueryOverlap = 0, //whether the shapes overlap. contact_count is 0, the rest of the manifold is unspecified
+		QueryPenetration, //also normal and penetration, without contact points. contact_count is 0
+		QueryContacts //the whole manifold
+	};
+
+	//simplex of the last distance query of a pair. passing it again starts gjk from there
+	struct SPC_SimplexCache
+	{
+		Real metric; //length or area of the simplex
+		unsigned int count; //0 for an empty cache
+		unsigned short indexA[3]; //vertices of A
+		unsigned short indexB[3]; //vertices of B
+	};
+
+	struct SPC_DistanceResult
+	{
+		Vec2 pointA; //closest point on A
+		Vec2 pointB; //closest point on B
+		Vec2 normal; //from A to B. zero when the shapes overlap
+		Real distance; //0 when the shapes overlap
+		int iterations;
+	};
+
+	//motion of a shape over a step, linear in t from 0 to 1. at t the shape is turned by rotation * t degrees around center,
+	//then moved by translation * t. the shape itself is the state at t = 0. an aabb turns as a box
+	struct SPC_Sweep
+	{
+		Vec2 center;
+		Vec2 translation;
+		Real rotation;
+	};
+
+	struct SPC_TOIResult
+	{
+		enum State
+		{
+			Separated = 0, //no contact in the step. t is 1
+			Touching, //the shapes touch at t
+			Overlapped, //the shapes overlap at t = 0
+			Failed //no answer in MAX_TOI_ITERATIONS. t is still safe, the shapes don't touch before it
+		};
+
+		State state;
+		Real t;
+		Vec2 normal; //from A to B, when touching
+		int iterations;
+	};
+
+	//hits collected by Collision::RaycastShape during a broadphase raycast
+	struct SPC_RaycastResult
+	{
+		Vec2 origin;
+		Vec2 dir;
+		SPC_RaycastMode mode;
+		SPC_RaycastHit* hits;
+		int capacity;
+		int count; //hits found. can be larger than capacity in RaycastAll mode
+	};
+
 	namespace Collision
 	{
-		int Clip(Vec2 n, double c, Vec2* face);
+		int Clip(Vec2 n, Real c, Vec2* face);
+
+		//same, keeping the feature ids of the points. a point made by clipping gets clipID
+		int Clip(Vec2 n, Real c, Vec2* face, SPC_ContactID* ids, SPC_ContactID clipID);
+
+		Real FindAxisLeastPenetration(unsigned int* faceIndex, Vec2* a, Vec2* normals, unsigned int n, Vec2* b, unsigned int m);
 
-		double FindAxisLeastPenetration(unsigned int* faceIndex, Vec2* a, Vec2* normals, unsigned int n, Vec2* b, unsigned int m);
+		//same, with the normals of b for the binary search of GetSupport when b is large
+		Real FindAxisLeastPenetration(unsigned int* faceIndex, Vec2* a, Vec2* normals, unsigned int n, Vec2* b, Vec2* bNormals, unsigned int m);
 
-		void FindIncidentFace(Vec2* v, Vec2 refNormal, Vec2* incVertices, Vec2* incNormals, unsigned int n);
+		//returns the index of the incident face
+		unsigned int FindIncidentFace(Vec2* v, Vec2 refNormal, Vec2* incVertices, Vec2* incNormals, unsigned int n);
 
 		bool AABB_to_AABB(SPC_AABB& a, SPC_AABB& b);
 
 		bool AABB_to_AABB(SPC_Manifold* m);
 
+		//the manifold functions below run on raw shape data, and leave m->A and m->B alone. they are the only kernel of each pair,
+		//the SPC_Shape versions (and the bool ones, at QueryOverlap) call them
+		bool AABB_to_AABB(Vec2 aMin, Vec2 aMax, Vec2 bMin, Vec2 bMax, SPC_Manifold* m, SPC_QueryLevel level = QueryContacts);
+
 		bool AABB_to_Circle(SPC_AABB& a, SPC_Circle& b);
 
 		bool AABB_to_Circle(SPC_Manifold* m);
 
+		bool AABB_to_Circle(Vec2 aMin, Vec2 aMax, Vec2 position, Real radius, SPC_Manifold* m, SPC_QueryLevel level = QueryContacts);
+
 		bool Circle_to_AABB(SPC_Manifold* m);
 
 		bool AABB_to_Polygon(SPC_AABB& a, SPC_Polygon& b);
 
 		bool AABB_to_Polygon(SPC_Manifold* m);
 
+		bool AABB_to_Polygon(SPC_Manifold* m, SPC_SATCache* cache);
+
 		bool Polygon_to_AABB(SPC_Manifold* m);
 
+		bool Polygon_to_AABB(SPC_Manifold* m, SPC_SATCache* cache);
+
 		bool Circle_to_Circle(SPC_Circle& a, SPC_Circle& b);
 
 		bool Circle_to_Circle(SPC_Manifold* m);
 
+		bool Circle_to_Circle(Vec2 aPosition, Real aRadius, Vec2 bPosition, Real bRadius, SPC_Manifold* m, SPC_QueryLevel level = QueryContacts);
+
 		bool Circle_to_Polygon(SPC_Circle& a, SPC_Polygon& b);
 
 		bool Circle_to_Polygon(SPC_Manifold* m);
 
+		bool Circle_to_Polygon(Vec2 position, Real radius, Vec2* vertices, Vec2* normals, unsigned int count, SPC_Manifold* m, SPC_QueryLevel level = QueryContacts);
+
 		bool Polygon_to_Circle(SPC_Manifold* m);
 
 		bool Polygon_to_Polygon(SPC_Polygon& a, SPC_Polygon& b);
 
 		bool Polygon_to_Polygon(SPC_Manifold* m);
 
+		bool Polygon_to_Polygon(SPC_Manifold* m, SPC_SATCache* cache);
+
+		//also used for aabbs, with their corners and AABB_normals. at QueryPenetration the penetration is the depth found by the SAT,
+		//at QueryContacts the mean depth of the clipped contact points
+		bool Polygon_to_Polygon(Vec2* aVertices, Vec2* aNormals, unsigned int aCount, Vec2* bVertices, Vec2* bNormals, unsigned int bCount, SPC_Manifold* m, SPC_SATCache* cache = nullptr, SPC_QueryLevel level = QueryContacts);
+
+		//the contacts of a pair which a query below QueryContacts found overlapping, with the same cache. the reference face is the
+		//face kept in the cache, so the SAT isn't run again. false when nothing is left after clipping
+		bool ComputeContacts(Vec2* aVertices, Vec2* aNormals, unsigned int aCount, Vec2* bVertices, Vec2* bNormals, unsigned int bCount, SPC_Manifold* m, const SPC_SATCache& cache);
+
+		//for a pair tested in the other order: the normal turns around and the reference shape changes side
+		inline void FlipManifold(SPC_Manifold* m)
+		{
+			m->normal = -m->normal;
+			for (unsigned int i = 0; i < m->contact_count; i++)
+				m->ids[i].flip ^= 1;
+		}
+
+		//narrowphase of a pair of shape types, chosen at compile time. a new shape type is added by specializing this for
+		//(NewType, OtherType) with a static Collide and flipped = false. the other order comes from the primary template
+		template <typename A, typename B>
+		struct SPC_PairKernel
+		{
+			static const bool flipped = true;
+
+			static bool Collide(A& a, B& b, SPC_Manifold* m, SPC_SATCache* cache, SPC_QueryLevel level)
+			{
+				static_assert(!SPC_PairKernel<B, A>::flipped, "no SPC_PairKernel for this pair of shapes, in either order");
+
+				bool ret = SPC_PairKernel<B, A>::Collide(b, a, m, cache, level);
+				if (level != QueryOverlap)
+					FlipManifold(m);
+
+				return ret;
+			}
+		};
+
+		template <>
+		struct SPC_PairKernel<SPC_AABB, SPC_AABB>
+		{
+			static const bool flipped = false;
+
+			static bool Collide(SPC_AABB& a, SPC_AABB& b, SPC_Manifold* m, SPC_SATCache*, SPC_QueryLevel level)
+			{
+				return AABB_to_AABB(a.min, a.max, b.min, b.max, m, level);
+			}
+		};
+
+		template <>
+		struct SPC_PairKernel<SPC_AABB, SPC_Circle>
+		{
+			static const bool flipped = false;
+
+			static bool Collide(SPC_AABB& a, SPC_Circle& b, SPC_Manifold* m, SPC_SATCache*, SPC_QueryLevel level)
+			{
+				return AABB_to_Circle(a.min, a.max, b.position, b.radius, m, level);
+			}
+		};
+
+		template <>
+		struct SPC_PairKernel<SPC_AABB, SPC_Polygon>
+		{
+			static const bool flipped = false;
+
+			static bool Collide(SPC_AABB& a, SPC_Polygon& b, SPC_Manifold* m, SPC_SATCache* cache, SPC_QueryLevel level)
+			{
+				Vec2 corners[4];
+				a.GetVertices(corners);
+
+				return Polygon_to_Polygon(corners, (Vec2*)AABB_normals, 4, b.vertices, b.normals, b.vertexCount, m, cache, level);
+			}
+		};
+
+		template <>
+		struct SPC_PairKernel<SPC_Circle, SPC_Circle>
+		{
+			static const bool flipped = false;
+
+			static bool Collide(SPC_Circle& a, SPC_Circle& b, SPC_Manifold* m, SPC_SATCache*, SPC_QueryLevel level)
+			{
+				return Circle_to_Circle(a.position, a.radius, b.position, b.radius, m, level);
+			}
+		};
+
+		template <>
+		struct SPC_PairKernel<SPC_Circle, SPC_Polygon>
+		{
+			static const bool flipped = false;
+
+			static bool Collide(SPC_Circle& a, SPC_Polygon& b, SPC_Manifold* m, SPC_SATCache*, SPC_QueryLevel level)
+			{
+				return Circle_to_Polygon(a.position, a.radius, b.vertices, b.normals, b.vertexCount, m, level);
+			}
+		};
+
+		template <>
+		struct SPC_PairKernel<SPC_Polygon, SPC_Polygon>
+		{
+			static const bool flipped = false;
+
+			static bool Collide(SPC_Polygon& a, SPC_Polygon& b, SPC_Manifold* m, SPC_SATCache* cache, SPC_QueryLevel level)
+			{
+				return Polygon_to_Polygon(a.vertices, a.normals, a.vertexCount, b.vertices, b.normals, b.vertexCount, m, cache, level);
+			}
+		};
+
+		//no table, virtual call or cast between the call and the kernel. m->A and m->B are left alone.
+		//same results as Collide(SPC_Manifold*) on the same shapes. the cache is used by the pairs of polygons and aabbs
+		template <typename A, typename B, typename = std::enable_if_t<std::is_base_of_v<SPC_Shape, A> && std::is_base_of_v<SPC_Shape, B>>>
+		inline bool Collide(A& a, B& b, SPC_Manifold* m, SPC_SATCache* cache = nullptr, SPC_QueryLevel level = QueryContacts)
+		{
+			return SPC_PairKernel<A, B>::Collide(a, b, m, cache, level);
+		}
+
+		//shapes held by value in variants (see SPC_ShapeVariant), dispatched by std::visit
+		template <typename... A, typename... B>
+		inline bool Collide(std::variant<A...>& a, std::variant<B...>& b, SPC_Manifold* m, SPC_SATCache* cache = nullptr, SPC_QueryLevel level = QueryContacts)
+		{
+			return std::visit([m, cache, level](auto& x, auto& y) { return Collide(x, y, m, cache, level); }, a, b);
+		}
+
+		//the manifold version of the kernel of A and B. m->A must be an A and m->B a B
+		template <typename A, typename B>
+		bool QueryPair(SPC_Manifold* m, SPC_SATCache* cache, SPC_QueryLevel level)
+		{
+			return SPC_PairKernel<A, B>::Collide(*static_cast<A*>(m->A), *static_cast<B*>(m->B), m, cache, level);
+		}
+
+		template <typename A, typename B>
+		bool CollidePair(SPC_Manifold* m)
+		{
+			return QueryPair<A, B>(m, nullptr, QueryContacts);
+		}
+
+		//narrowphase on a pair list where every m->A is an A and every m->B a B, like the pairs of a broadphase sorted by types.
+		//the kernel is called directly in the loop. colliding manifolds are moved to the front, keeping their order. returns the count
+		template <typename A, typename B>
+		int CollideAll(SPC_Manifold* pairs, int count, SPC_QueryLevel level = QueryContacts)
+		{
+			int hits = 0;
+			for (int i = 0; i < count; i++)
+			{
+				if (!QueryPair<A, B>(&pairs[i], nullptr, level))
+					continue;
+
+				if (hits != i)
+					pairs[hits] = pairs[i];
+
+				hits++;
+			}
+
+			return hits;
+		}
+
 		typedef bool (*SPC_CollideCallback) (SPC_Manifold* manifold);
 
+		//indexed by SPC_Shape::ShapeType, for shapes only known at run time
 		static const SPC_CollideCallback CollideFunc[SPC_Shape::Count][SPC_Shape::Count] =
 		{
-			{ AABB_to_AABB, AABB_to_Circle, AABB_to_Polygon },
-			{ Circle_to_AABB, Circle_to_Circle, Circle_to_Polygon },
-			{ Polygon_to_AABB, Polygon_to_Circle, Polygon_to_Polygon }
+			{ CollidePair<SPC_AABB, SPC_AABB>, CollidePair<SPC_AABB, SPC_Circle>, CollidePair<SPC_AABB, SPC_Polygon> },
+			{ CollidePair<SPC_Circle, SPC_AABB>, CollidePair<SPC_Circle, SPC_Circle>, CollidePair<SPC_Circle, SPC_Polygon> },
+			{ CollidePair<SPC_Polygon, SPC_AABB>, CollidePair<SPC_Polygon, SPC_Circle>, CollidePair<SPC_Polygon, SPC_Polygon> }
+		};
+
+		typedef bool (*SPC_QueryFunc) (SPC_Manifold* manifold, SPC_SATCache* cache, SPC_QueryLevel level);
+
+		static const SPC_QueryFunc QueryFunc[SPC_Shape::Count][SPC_Shape::Count] =
+		{
+			{ QueryPair<SPC_AABB, SPC_AABB>, QueryPair<SPC_AABB, SPC_Circle>, QueryPair<SPC_AABB, SPC_Polygon> },
+			{ QueryPair<SPC_Circle, SPC_AABB>, QueryPair<SPC_Circle, SPC_Circle>, QueryPair<SPC_Circle, SPC_Polygon> },
+			{ QueryPair<SPC_Polygon, SPC_AABB>, QueryPair<SPC_Polygon, SPC_Circle>, QueryPair<SPC_Polygon, SPC_Polygon> }
 		};
 
 		bool Collide(SPC_Manifold* m);
 
+		//the cache is used by the pairs with a polygon and a polygon or an aabb. it is ignored by the others
+		bool Collide(SPC_Manifold* m, SPC_SATCache* cache);
+
+		bool Collide(SPC_Manifold* m, SPC_SATCache* cache, SPC_QueryLevel level);
+
+		//completes a manifold of a query below QueryContacts which returned true, with the same cache. pairs with a polygon and a
+		//polygon or an aabb clip on the face kept in the cache. the others, and any pair without a valid cache, run their kernel again
+		bool ComputeContacts(SPC_Manifold* m, SPC_SATCache* cache);
+
+		//overlap test only, through the same table as Collide(SPC_Manifold*, SPC_SATCache*, SPC_QueryLevel) at QueryOverlap
 		bool Collide(SPC_Shape* a, SPC_Shape* b);
+
+		//shapes in local space, placed in the world by a transform. the manifold is in world space, and m->A and m->B are left alone.
+		//moving a shape changes only its transform. a polygon pair moves the vertices of the smaller one into the space of the other
+		bool Circle_to_Circle(SPC_Circle& a, const SPC_Transform2D& ta, SPC_Circle& b, const SPC_Transform2D& tb, SPC_Manifold* m);
+
+		bool Circle_to_Polygon(SPC_Circle& a, const SPC_Transform2D& ta, SPC_Polygon& b, const SPC_Transform2D& tb, SPC_Manifold* m);
+
+		bool Polygon_to_Circle(SPC_Polygon& a, const SPC_Transform2D& ta, SPC_Circle& b, const SPC_Transform2D& tb, SPC_Manifold* m);
+
+		bool Polygon_to_Polygon(SPC_Polygon& a, const SPC_Transform2D& ta, SPC_Polygon& b, const SPC_Transform2D& tb, SPC_Manifold* m, SPC_SATCache* cache = nullptr);
+
+		//any pair of types. an aabb under a turned transform is a box
+		bool Collide(SPC_Shape* a, const SPC_Transform2D& ta, SPC_Shape* b, const SPC_Transform2D& tb, SPC_Manifold* m, SPC_SATCache* cache = nullptr);
+
+		//shapes moved by an offset each. nothing is copied to the heap, the polygon vertices are moved on the stack up to SPC_Polygon::STACK_POLY of them,
+		//and bigger hulls in a buffer of the thread which allocates only when it grows
+		bool Collide(SPC_Shape* a, Vec2 offsetA, SPC_Shape* b, Vec2 offsetB, SPC_Manifold* m, SPC_SATCache* cache = nullptr);
+
+		bool Collide(const SPC_ShapeView& a, const SPC_ShapeView& b, SPC_Manifold* m, SPC_SATCache* cache = nullptr);
+
+		//find pairs of shapes whose aabbs overlap, with a sweep and prune kept per thread. A and B of out_pairs are set (A has the smaller index).
+		//returns the number of pairs found. only the first capacity pairs are written.
+		//buffers are reused between calls, so there is no heap allocation once the shape count stops growing
+		int FindPairs(SPC_Shape** shapes, int count, SPC_Manifold* out_pairs, int capacity);
+
+		//same, with the aabbs and the sweep computed by the workers of the pool. the pairs come in the same order
+		int FindPairs(SPC_Shape** shapes, int count, SPC_Manifold* out_pairs, int capacity, SPC_ThreadPool& pool);
+
+		//narrowphase on a pair list. colliding manifolds are moved to the front, keeping their order. returns the count
+		int CollideAll(SPC_Manifold* pairs, int count);
+
+		//broadphase and narrowphase. only colliding manifolds are written to out.
+		//returns the number of collisions found. only the first capacity manifolds are written
+		int CollideAll(SPC_Shape** shapes, int count, SPC_Manifold* out, int capacity);
+
+		//cast a ray from origin to origin + maxT * dir. dir doesn't have to be normalized, t is measured in its length.
+		//a ray starting inside the shape doesn't hit it. shape and proxyId of the hit are not set
+		bool Raycast(const SPC_AABB& a, Vec2 origin, Vec2 dir, Real maxT, SPC_RaycastHit* hit);
+
+		bool Raycast(const SPC_Circle& a, Vec2 origin, Vec2 dir, Real maxT, SPC_RaycastHit* hit);
+
+		bool Raycast(const SPC_Polygon& a, Vec2 origin, Vec2 dir, Real maxT, SPC_RaycastHit* hit);
+
+		bool Raycast(SPC_Shape* shape, Vec2 origin, Vec2 dir, Real maxT, SPC_RaycastHit* hit);
+
+		//true if the ray crosses the box before maxT. a ray starting inside the box crosses it
+		bool RayOverlap(Vec2 min, Vec2 max, Vec2 origin, Vec2 dir, Real maxT);
+
+		//SPC_RayCallback running the raycast on the shape. data is an SPC_RaycastResult, which gets the hits by its mode
+		Real RaycastShape(int proxyId, SPC_Shape* shape, Real maxT, void* data);
+
+		const int MAX_TOI_ITERATIONS = 64;
+		const int MAX_GJK_ITERATIONS = 20;
+
+		//lower bound of the distance between a and b, over their faces and the axes between their centers and closest vertices.
+		//negative when they overlap. normal is the best axis (from a to b)
+		Real SeparationBound(SPC_Shape* a, SPC_Shape* b, Vec2* normal);
+
+		//distance and closest points of two shapes by gjk. the cache can be kept between frames, count = 0 for a new one
+		Real Distance(SPC_Shape* a, SPC_Shape* b, SPC_DistanceResult* result, SPC_SimplexCache* cache = nullptr);
+
+		//first time in the sweeps when the shapes come within tolerance, by conservative advancement on the gjk distance.
+		//returns true when they touch or overlap in the step
+		bool TimeOfImpact(SPC_Shape* a, const SPC_Sweep& sweepA, SPC_Shape* b, const SPC_Sweep& sweepB, SPC_TOIResult* result, Real tolerance = 1e-3);
+
+		//rough relative cost of the narrowphase of a pair, from the shape types and the vertex counts
+		double EstimateCost(SPC_Manifold* m);
+
+		//parallel narrowphase. the list is split in contiguous chunks of about the same estimated cost, each chunk is compacted
+		//in place by a worker, then the chunks are merged in order. the result is the same as the single threaded one, bit for bit
+		int CollideAll(SPC_Manifold* pairs, int count, SPC_ThreadPool& pool);
+
+		//parallel broadphase and narrowphase. pairs are collected in out and collided whenever it is full
+		int CollideAll(SPC_Shape** shapes, int count, SPC_Manifold* out, int capacity, SPC_ThreadPool& pool);
 	}
 }
 #endif
\ No newline at end of file
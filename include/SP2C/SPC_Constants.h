@@ -2,12 +2,27 @@
 #ifndef __SPC_CONSTANTS__
 #define __SPC_CONSTANTS__
 
+#include <cfloat>
+
 namespace SP2C
 {
+	//scalar type of the whole library. define SP2C_USE_FLOAT (for every file, library and user code) to build it with float
+#ifdef SP2C_USE_FLOAT
+	typedef float Real;
+
+	const Real REAL_MAX = FLT_MAX;
+	const Real REAL_EPSILON = FLT_EPSILON;
+#else
+	typedef double Real;
+
+	const Real REAL_MAX = DBL_MAX;
+	const Real REAL_EPSILON = DBL_EPSILON;
+#endif
+
 	namespace Const
 	{
-		const double PI = 3.141592653589793;
-		const double RAD = PI / 180;
+		const Real PI = (Real)3.141592653589793;
+		const Real RAD = PI / 180;
 	}
 }
 
@@ -0,0 +1,101 @@
+#pragma once
+#ifndef __SPC_DYNAMICTREE__
+#define __SPC_DYNAMICTREE__
+
+#include <vector>
+#include <SP2C/SPC_Vector.h>
+#include <SP2C/SPC_Shapes.h>
+#include <SP2C/SPC_Manifold.h>
+#include <SP2C/SPC_Broadphase.h>
+#include <SP2C/SPC_Collision.h>
+
+namespace SP2C
+{
+	struct SPC_TreeNode
+	{
+		SPC_AABB aabb; //fat aabb for leaves, union of children for branches
+		SPC_Shape* shape;
+
+		int parent; //next free node when the node is not used
+		int child1;
+		int child2;
+
+		int height; //leaf = 0, free node = -1
+
+		bool IsLeaf() const;
+	};
+
+	//aabb tree for moving shapes. leaves hold fat aabbs, so small movements don't touch the tree.
+	//branches are chosen by the surface area heuristic (GetArea) and balanced with rotations
+	struct SPC_DynamicTree
+	{
+		static const int STACK_SIZE = 256;
+
+		std::vector<SPC_TreeNode> nodes;
+		int root;
+		int freeList;
+		int proxyCount;
+
+		Real margin; //extension of the fat aabb on each side
+		Real displacementMultiplier; //extension of the fat aabb along the displacement
+
+		SPC_DynamicTree(Real margin = 1, Real displacementMultiplier = 2);
+
+		//insert a shape with its current aabb. returns the proxy id
+		int CreateProxy(SPC_Shape* shape);
+
+		int CreateProxy(const SPC_AABB& aabb, SPC_Shape* shape);
+
+		void DestroyProxy(int proxyId);
+
+		//returns true if the proxy was reinserted. nothing happens while the fat aabb still contains the aabb
+		bool MoveProxy(int proxyId, const SPC_AABB& aabb, Vec2 displacement = VEC_ZERO);
+
+		//recompute the aabb from the shape of the proxy and move it
+		bool UpdateProxy(int proxyId, Vec2 displacement = VEC_ZERO);
+
+		SPC_Shape* GetShape(int proxyId) const;
+
+		const SPC_AABB& GetFatAABB(int proxyId) const;
+
+		void Query(SPC_AABB aabb, SPC_QueryCallback callback, void* data);
+
+		//report every pair of proxies whose fat aabbs overlap, each pair once
+		void QueryPairs(SPC_PairCallback callback, void* data);
+
+		//report the proxies whose fat aabbs the ray from origin to origin + maxT * dir crosses. see SPC_RayCallback
+		void Raycast(Vec2 origin, Vec2 dir, Real maxT, SPC_RayCallback callback, void* data) const;
+
+		//cast the ray against the shapes. returns the number of hits, and only the first capacity are written
+		int Raycast(Vec2 origin, Vec2 dir, Real maxT, SPC_RaycastMode mode, SPC_RaycastHit* hits, int capacity) const;
+
+		int GetHeight() const;
+
+		//max difference of the children heights in the tree
+		int GetMaxBalance() const;
+
+		//sum of the branch areas divided by the root area. lower is better
+		Real GetAreaRatio() const;
+
+		//check the tree structure with assert
+		void Validate() const;
+
+		void Clear();
+
+	private:
+		int AllocateNode();
+
+		void FreeNode(int nodeId);
+
+		void InsertLeaf(int leaf);
+
+		void RemoveLeaf(int leaf);
+
+		int Balance(int iA);
+
+		int ComputeHeight(int nodeId) const;
+
+		void ValidateNode(int nodeId) const;
+	};
+}
+#endif
\ No newline at end of file
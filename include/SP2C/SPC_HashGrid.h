@@ -0,0 +1,79 @@
+#pragma once
+#ifndef __SPC_HASHGRID__
+#define __SPC_HASHGRID__
+
+#include <vector>
+#include <SP2C/SPC_Vector.h>
+#include <SP2C/SPC_Shapes.h>
+#include <SP2C/SPC_Manifold.h>
+#include <SP2C/SPC_Broadphase.h>
+#include <SP2C/SPC_Batch.h>
+
+namespace SP2C
+{
+	struct SPC_GridItem
+	{
+		int cx; //cell of the circle center
+		int cy;
+		int index; //index of the circle in the built array
+		Vec2 min; //aabb of the circle
+		Vec2 max;
+	};
+
+	//uniform grid for many circles of similar size. each circle is put in the cell of its center,
+	//so the cell size should be at least the diameter of the circles. bigger circles are kept in a separate list.
+	//cells are hashed into a table rebuilt every frame with a counting sort, so nothing is allocated per cell
+	struct SPC_HashGrid
+	{
+		static const int HISTOGRAM_SIZE = 32;
+
+		Real cellSize; //0 means tune from the radii on each build
+		Real percentile; //fraction of the circles which should fit in a cell when tuning
+
+		std::vector<SPC_Circle*> circles;
+		std::vector<SPC_GridItem> items; //sorted by bucket
+		std::vector<unsigned int> buckets; //start of each bucket in items. size is tableSize + 1
+		std::vector<SPC_GridItem> large; //circles bigger than the cell
+		unsigned int tableSize;
+
+		SPC_HashGrid(Real cellSize = 0, Real percentile = 0.95);
+
+		//cell size from the radius histogram. the smallest size which fits the given percentile of circles
+		static Real TuneCellSize(SPC_Circle** circles, int count, Real percentile = 0.95);
+
+		void Build(SPC_Circle** circles, int count);
+
+		SPC_Circle* GetCircle(int index) const;
+
+		Real GetCellSize() const;
+
+		//report circles whose aabbs overlap the query aabb. proxy id is the index in the built array
+		void Query(SPC_AABB aabb, SPC_QueryCallback callback, void* data);
+
+		//report every pair of circles whose aabbs overlap, each pair once. A has the smaller index.
+		//each cell visits itself and half of its neighbours, so every pair of neighbour cells is visited once
+		void QueryPairs(SPC_PairCallback callback, void* data);
+
+		void Clear();
+
+	private:
+		Real currentSize;
+		Real inverseSize;
+		std::vector<SPC_GridItem> unsorted;
+
+		//bounds of the items by component, for the batch test when every item is checked
+		std::vector<Real> itemMinX;
+		std::vector<Real> itemMinY;
+		std::vector<Real> itemMaxX;
+		std::vector<Real> itemMaxY;
+
+		unsigned int Hash(int cx, int cy) const;
+
+		int GetCell(Real v) const;
+
+		//test the items begin to begin + 31 against the aabb. bit i of the result is set when item begin + i overlaps.
+		//the mask is returned, so the callbacks of a query can run more queries
+		unsigned int ScanItems(Vec2 min, Vec2 max, unsigned int begin) const;
+	};
+}
+#endif
\ No newline at end of file
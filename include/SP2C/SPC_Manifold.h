@@ -7,14 +7,37 @@
 
 namespace SP2C
 {
+	//which features of the shapes made a contact point. the same id in the next frame means the same contact
+	struct SPC_ContactID
+	{
+		enum FeatureType
+		{
+			Vertex = 0, //a vertex of the incident shape
+			ClippedNeg, //the incident edge clipped by the side plane at the start of the reference face
+			ClippedPos, //the incident edge clipped by the side plane at the end of the reference face
+			Face, //a face of the reference shape. circles
+			Corner //a vertex of the reference shape. circles
+		};
+
+		unsigned short reference; //face (or vertex) of the reference shape
+		unsigned short incident; //vertex (or edge, when clipped) of the incident shape
+		unsigned char flip; //1 when the reference shape is B
+		unsigned char type;
+
+		bool operator==(SPC_ContactID id) const;
+
+		bool operator!=(SPC_ContactID id) const;
+	};
+
 	struct SPC_Manifold
 	{
 		SPC_Shape* A;
 		SPC_Shape* B;
 		Vec2 contact_points[2];
-		Vec2 normal; //normal vector from A to B
+		SPC_ContactID ids[2]; //feature ids of the contact points
+		Vec2 normal; //normal vector from A to B. for a polygon pair which doesn't collide, the separating axis
 		unsigned int contact_count;
-		double penetration;
+		Real penetration;
 	};
 }
 #endif
\ No newline at end of file
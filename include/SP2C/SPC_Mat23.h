@@ -0,0 +1,102 @@
+#pragma once
+#ifndef __SPC_MAT23__
+#define __SPC_MAT23__
+
+#include <cassert>
+#include <cmath>
+#include <SP2C/SPC_Constants.h>
+#include <SP2C/SPC_Vector.h>
+#include <SP2C/SPC_Mat33.h>
+#include <SP2C/SPC_Transform.h>
+
+namespace SP2C
+{
+	//affine transform, the first two rows of an SPC_Mat33 (the last one is always 0 0 1).
+	//v goes to (m00 * x + m01 * y + m02, m10 * x + m11 * y + m12)
+	struct SPC_Mat23
+	{
+		Real m[2][3];
+
+		constexpr SPC_Mat23(Real m00, Real m01, Real m02, Real m10, Real m11, Real m12)
+			: m{ { m00, m01, m02 }, { m10, m11, m12 } }
+		{
+		}
+
+		//identity
+		constexpr SPC_Mat23() : SPC_Mat23(1, 0, 0, 0, 1, 0)
+		{
+		}
+
+		constexpr SPC_Mat23(const SPC_Transform2D& t) : SPC_Mat23(t.cos, -t.sin, t.position.x, t.sin, t.cos, t.position.y)
+		{
+		}
+
+		constexpr SPC_Mat23(const SPC_Mat33& mat) : SPC_Mat23(mat.m[0][0], mat.m[0][1], mat.m[0][2], mat.m[1][0], mat.m[1][1], mat.m[1][2])
+		{
+		}
+
+		//mat first, then this
+		constexpr SPC_Mat23 operator*(const SPC_Mat23& mat) const
+		{
+			return SPC_Mat23(
+				m[0][0] * mat.m[0][0] + m[0][1] * mat.m[1][0], m[0][0] * mat.m[0][1] + m[0][1] * mat.m[1][1], m[0][0] * mat.m[0][2] + m[0][1] * mat.m[1][2] + m[0][2],
+				m[1][0] * mat.m[0][0] + m[1][1] * mat.m[1][0], m[1][0] * mat.m[0][1] + m[1][1] * mat.m[1][1], m[1][0] * mat.m[0][2] + m[1][1] * mat.m[1][2] + m[1][2]);
+		}
+
+		constexpr Vec2 operator*(Vec2 v) const
+		{
+			return Vec2(m[0][0] * v.x + m[0][1] * v.y + m[0][2], m[1][0] * v.x + m[1][1] * v.y + m[1][2]);
+		}
+
+		//without the translation, for directions and the normals of a rigid transform
+		constexpr Vec2 ApplyLinear(Vec2 v) const
+		{
+			return Vec2(m[0][0] * v.x + m[0][1] * v.y, m[1][0] * v.x + m[1][1] * v.y);
+		}
+
+		constexpr Real Determinant() const
+		{
+			return m[0][0] * m[1][1] - m[0][1] * m[1][0];
+		}
+
+		constexpr SPC_Mat23 Inverse() const
+		{
+			Real det = Determinant();
+			assert(det != 0);
+			Real invdet = 1 / det;
+
+			Real a = m[1][1] * invdet, b = -m[0][1] * invdet;
+			Real c = -m[1][0] * invdet, d = m[0][0] * invdet;
+
+			return SPC_Mat23(a, b, -(a * m[0][2] + b * m[1][2]), c, d, -(c * m[0][2] + d * m[1][2]));
+		}
+
+		//these come after the current transform, like calling the functions of a shape one after another. Scale and Rotate are about (0, 0)
+		constexpr void Translate(Real x, Real y)
+		{
+			m[0][2] += x;
+			m[1][2] += y;
+		}
+
+		constexpr void Translate(Vec2 p)
+		{
+			m[0][2] += p.x;
+			m[1][2] += p.y;
+		}
+
+		constexpr void Scale(Real k)
+		{
+			for (int i = 0; i < 2; i++)
+				for (int j = 0; j < 3; j++)
+					m[i][j] *= k;
+		}
+
+		void Rotate(Real deg)
+		{
+			*this = SPC_Mat23(SPC_Transform2D(VEC_ZERO, deg)) * *this;
+		}
+	};
+
+	constexpr SPC_Mat23 SPC_MAT23_IDENTITY = SPC_Mat23();
+}
+#endif
\ No newline at end of file
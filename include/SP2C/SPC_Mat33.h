@@ -11,49 +11,177 @@ namespace SP2C
 {
 	struct SPC_Mat33
 	{
-		double m[3][3];
-
-		SPC_Mat33(double m00, double m01, double m02, double m10, double m11, double m12, double m20, double m21, double m22);
-
-		SPC_Mat33(double** mat);
-
-		SPC_Mat33();
-
-		SPC_Mat33 operator+(SPC_Mat33 mat);
-
-		SPC_Mat33 operator-(SPC_Mat33 mat);
-
-		SPC_Mat33 operator*(double k);
-
-		SPC_Mat33 operator*(SPC_Mat33 mat);
-
-		Vec2 operator*(Vec2 v);
-
-		SPC_Mat33& operator+=(SPC_Mat33 mat);
-
-		SPC_Mat33& operator-=(SPC_Mat33 mat);
-
-		SPC_Mat33& operator*=(double k);
-
-		SPC_Mat33& operator=(SPC_Mat33 mat);
-
-		SPC_Mat33& operator*=(SPC_Mat33 mat);
-
-		SPC_Mat33 Transpose();
-
-		double Determinant();
-
-		SPC_Mat33 Inverse();
-
-		void Translate(double x, double y);
-
-		void Translate(Vec2 p);
-
-		void Scale(double k);
-
-		void Rotate(double deg);
+		Real m[3][3];
+
+		constexpr SPC_Mat33(Real m00, Real m01, Real m02, Real m10, Real m11, Real m12, Real m20, Real m21, Real m22)
+			: m{ { m00, m01, m02 }, { m10, m11, m12 }, { m20, m21, m22 } }
+		{
+		}
+
+		SPC_Mat33(Real** mat) : m{}
+		{
+			for (int i = 0; i < 3; i++)
+				for (int j = 0; j < 3; j++)
+					m[i][j] = mat[i][j];
+		}
+
+		constexpr SPC_Mat33() : m{}
+		{
+		}
+
+		constexpr SPC_Mat33 operator+(SPC_Mat33 mat) const
+		{
+			SPC_Mat33 ret;
+			for (int i = 0; i < 3; i++)
+				for (int j = 0; j < 3; j++)
+					ret.m[i][j] = m[i][j] + mat.m[i][j];
+
+			return ret;
+		}
+
+		constexpr SPC_Mat33 operator-(SPC_Mat33 mat) const
+		{
+			SPC_Mat33 ret;
+			for (int i = 0; i < 3; i++)
+				for (int j = 0; j < 3; j++)
+					ret.m[i][j] = m[i][j] - mat.m[i][j];
+
+			return ret;
+		}
+
+		constexpr SPC_Mat33 operator*(Real k) const
+		{
+			SPC_Mat33 ret;
+			for (int i = 0; i < 3; i++)
+				for (int j = 0; j < 3; j++)
+					ret.m[i][j] = m[i][j] * k;
+
+			return ret;
+		}
+
+		constexpr SPC_Mat33 operator*(SPC_Mat33 mat) const
+		{
+			SPC_Mat33 ret;
+			for (int i = 0; i < 3; i++)
+				for (int j = 0; j < 3; j++)
+					for (int k = 0; k < 3; k++)
+						ret.m[i][j] += m[i][k] * mat.m[k][j];
+
+			return ret;
+		}
+
+		constexpr Vec2 operator*(Vec2 v) const
+		{
+			return Vec2(m[0][0] * v.x + m[0][1] * v.y + m[0][2], m[1][0] * v.x + m[1][1] * v.y + m[1][2]);
+		}
+
+		constexpr SPC_Mat33& operator+=(SPC_Mat33 mat)
+		{
+			for (int i = 0; i < 3; i++)
+				for (int j = 0; j < 3; j++)
+					m[i][j] += mat.m[i][j];
+
+			return *this;
+		}
+
+		constexpr SPC_Mat33& operator-=(SPC_Mat33 mat)
+		{
+			for (int i = 0; i < 3; i++)
+				for (int j = 0; j < 3; j++)
+					m[i][j] -= mat.m[i][j];
+
+			return *this;
+		}
+
+		constexpr SPC_Mat33& operator*=(Real k)
+		{
+			for (int i = 0; i < 3; i++)
+				for (int j = 0; j < 3; j++)
+					m[i][j] *= k;
+
+			return *this;
+		}
+
+		constexpr SPC_Mat33& operator=(const SPC_Mat33& mat)
+		{
+			for (int i = 0; i < 3; i++)
+				for (int j = 0; j < 3; j++)
+					m[i][j] = mat.m[i][j];
+
+			return *this;
+		}
+
+		constexpr SPC_Mat33& operator*=(SPC_Mat33 mat)
+		{
+			*this = *this * mat;
+			return *this;
+		}
+
+		constexpr SPC_Mat33 Transpose() const
+		{
+			SPC_Mat33 ret;
+			for (int i = 0; i < 3; i++)
+				for (int j = 0; j < 3; j++)
+					ret.m[i][j] = m[j][i];
+
+			return ret;
+		}
+
+		constexpr Real Determinant() const
+		{
+			return m[0][0] * (m[1][1] * m[2][2] - m[2][1] * m[1][2]) -
+				m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) +
+				m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+		}
+
+		constexpr SPC_Mat33 Inverse() const
+		{
+			Real det = Determinant();
+			assert(det != 0);
+			Real invdet = 1 / det;
+
+			SPC_Mat33 ret;
+
+			ret.m[0][0] = (m[1][1] * m[2][2] - m[2][1] * m[1][2]) * invdet;
+			ret.m[0][1] = (m[0][2] * m[2][1] - m[0][1] * m[2][2]) * invdet;
+			ret.m[0][2] = (m[0][1] * m[1][2] - m[0][2] * m[1][1]) * invdet;
+			ret.m[1][0] = (m[1][2] * m[2][0] - m[1][0] * m[2][2]) * invdet;
+			ret.m[1][1] = (m[0][0] * m[2][2] - m[0][2] * m[2][0]) * invdet;
+			ret.m[1][2] = (m[1][0] * m[0][2] - m[0][0] * m[1][2]) * invdet;
+			ret.m[2][0] = (m[1][0] * m[2][1] - m[2][0] * m[1][1]) * invdet;
+			ret.m[2][1] = (m[2][0] * m[0][1] - m[0][0] * m[2][1]) * invdet;
+			ret.m[2][2] = (m[0][0] * m[1][1] - m[1][0] * m[0][1]) * invdet;
+
+			return ret;
+		}
+
+		constexpr void Translate(Real x, Real y)
+		{
+			m[0][2] += x;
+			m[1][2] += y;
+		}
+
+		constexpr void Translate(Vec2 p)
+		{
+			m[0][2] += p.x;
+			m[1][2] += p.y;
+		}
+
+		constexpr void Scale(Real k)
+		{
+			m[0][0] *= k;
+			m[1][1] *= k;
+		}
+
+		void Rotate(Real deg)
+		{
+			Real cos = std::cos(deg * Const::RAD);
+			Real sin = std::sin(deg * Const::RAD);
+
+			*this *= SPC_Mat33(cos, -sin, 0, sin, cos, 0, 0, 0, 0);
+		}
 	};
 
-	const SPC_Mat33 SPC_MAT_IDENTITY = SPC_Mat33(1, 0, 0, 0, 1, 0, 0, 0, 1);
+	constexpr SPC_Mat33 SPC_MAT_IDENTITY = SPC_Mat33(1, 0, 0, 0, 1, 0, 0, 0, 1);
 }
 #endif
\ No newline at end of file
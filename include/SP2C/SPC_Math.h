@@ -7,33 +7,110 @@
 #include <SP2C/SPC_Constants.h>
 #include <SP2C/SPC_Vector.h>
 #include <SP2C/SPC_Mat33.h>
+#include <SP2C/SPC_SIMD.h>
 
 namespace SP2C
 {
-	double DistanceSquared(Vec2 a, Vec2 b);
+	//the small helpers are defined here to be inlined into the loops that call them
 
-	double DotProduct(Vec2 a, Vec2 b);
+	constexpr Real DistanceSquared(Vec2 a, Vec2 b)
+	{
+		Real x = a.x - b.x, y = a.y - b.y;
+		return x * x + y * y;
+	}
 
-	double CrossProduct(Vec2 a, Vec2 b);
+	constexpr Real DotProduct(Vec2 a, Vec2 b)
+	{
+		return a.x * b.x + a.y * b.y;
+	}
 
-	Vec2 CrossProduct(Vec2 a, double k);
+	constexpr Real CrossProduct(Vec2 a, Vec2 b)
+	{
+		return a.x * b.y - a.y * b.x;
+	}
 
-	Vec2 CrossProduct(double k, Vec2 a);
+	constexpr Vec2 CrossProduct(Vec2 a, Real k)
+	{
+		return { k * a.y, -k * a.x };
+	}
 
-	double Clamp(double value, double min, double max);
+	constexpr Vec2 CrossProduct(Real k, Vec2 a)
+	{
+		return { -k * a.y, k * a.x };
+	}
 
-	double Pythagorean(double a, double b);
+	constexpr Real Clamp(Real value, Real min, Real max)
+	{
+		if (value <= min) return min;
+		if (value >= max) return max;
+		return value;
+	}
 
+	inline Real Pythagorean(Real a, Real b)
+	{
+		return std::sqrt(a * a + b * b);
+	}
+
+	//SIMD::WIDTH vertices at a time. the first vertex with the largest projection, as in a plain loop
 	Vec2 GetSupport(Vec2 dir, Vec2* vertices, unsigned int n);
 
-	Vec2 ScaleVec(Vec2 origin, Vec2 pivot, double k);
+	//merge the lanes of a SIMD search for the first largest value into best and bestIndex.
+	//lane k of indices is the first index of the block where the lane found its value, or -1 for none
+	void FirstMax(SIMD::Vector values, SIMD::Vector indices, Real* best, unsigned int* bestIndex);
+
+	//polygons with more vertices than this use the binary search in GetSupport
+	const unsigned int SUPPORT_SEARCH_THRESHOLD = 16;
+
+	//grows with the angle of v like atan2, in [0, 4), without trigonometry
+	Real PseudoAngle(Vec2 v);
+
+	//pseudo angles of the normals measured from normals[0]. they don't change when the polygon moves, turns or scales uniformly
+	void ComputeNormalAngles(Vec2* normals, unsigned int n, Real* angles);
+
+	//support vertex of a convex polygon (ccw vertices without collinear points, normals[i] is the normal of the face from vertex i),
+	//by binary search on the angles of the normals. angles are from ComputeNormalAngles, or nullptr to compute them on the way.
+	//the result is the same as the linear GetSupport, the lowest index among equal projections
+	unsigned int GetSupportIndex(Vec2 dir, Vec2* vertices, Vec2* normals, unsigned int n, const Real* angles = nullptr);
+
+	//linear scan for small polygons, binary search above SUPPORT_SEARCH_THRESHOLD
+	Vec2 GetSupport(Vec2 dir, Vec2* vertices, Vec2* normals, unsigned int n);
+
+	constexpr Vec2 ScaleVec(Vec2 origin, Vec2 pivot, Real k)
+	{
+		Vec2 d = origin - pivot;
+		return pivot + d * k;
+	}
+
+	inline Vec2 RotateVec(Vec2 origin, Vec2 pivot, Real deg)
+	{
+		Real rad = deg * Const::RAD;
+		Real sin = std::sin(rad), cos = std::cos(rad);
+
+		SPC_Mat33 T_inv(1, 0, -pivot.x, 0, 1, -pivot.y, 0, 0, 1);
+		SPC_Mat33 R(cos, -sin, 0, sin, cos, 0, 0, 0, 1);
+		SPC_Mat33 T(1, 0, pivot.x, 0, 1, pivot.y, 0, 0, 1);
 
-	Vec2 RotateVec(Vec2 origin, Vec2 pivot, double deg);
+		SPC_Mat33 M = T * R * T_inv;
+		return M * origin;
+	}
 
-	double ccwVal(Vec2 a, Vec2 b, Vec2 c);
+	constexpr Real ccwVal(Vec2 a, Vec2 b, Vec2 c)
+	{
+		return a.x * b.y + b.x * c.y + c.x * a.y - (a.y * b.x + b.y * c.x + c.y * a.x);
+	}
 
-	int ccw(Vec2 a, Vec2 b, Vec2 c);
+	constexpr int ccw(Vec2 a, Vec2 b, Vec2 c)
+	{
+		Real val = ccwVal(a, b, c);
+		if (val > 0) return 1;
+		else if (val < 0) return -1;
+		return 0;
+	}
 
-	bool InsideTriangle(Vec2 t1, Vec2 t2, Vec2 t3, Vec2 p);
+	constexpr bool InsideTriangle(Vec2 t1, Vec2 t2, Vec2 t3, Vec2 p)
+	{
+		Vec2 a = t2 - t1, b = t3 - t2, c = t1 - t3;
+		return (CrossProduct(a, p - t1) > 0 && CrossProduct(b, p - t2) > 0 && CrossProduct(c, p - t3) > 0);
+	}
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+#ifndef __SPC_PAIRCACHE__
+#define __SPC_PAIRCACHE__
+
+#include <vector>
+#include <SP2C/SPC_Vector.h>
+#include <SP2C/SPC_Shapes.h>
+#include <SP2C/SPC_Manifold.h>
+#include <SP2C/SPC_Collision.h>
+
+namespace SP2C
+{
+	struct SPC_PairCacheEntry
+	{
+		SPC_Shape* A; //nullptr when the slot is empty
+		SPC_Shape* B;
+		SPC_AABB aabbA; //aabbs of the shapes when the manifold was computed
+		SPC_AABB aabbB;
+		SPC_Manifold manifold; //last narrowphase result. manifold.A is nullptr when it has to be computed again
+		Vec2 axis; //contact normal, or separating axis of polygon pairs
+		SPC_SATCache sat; //face tested first by the next narrowphase of a polygon pair
+		unsigned int matched; //bit i is set when contact i has the same feature id as a contact of the frame before
+		unsigned int frame; //last frame the pair was used
+		bool touching;
+	};
+
+	//manifolds of shape pairs kept between frames, in an open addressing table keyed by (A, B).
+	//a pair whose shapes have the same aabbs as last time reuses the stored manifold without running the narrowphase,
+	//and new contacts are put in the same slots as the contacts with the same feature ids.
+	//a shape changed without changing its aabb (a square turned by 90 degrees) must be passed to Invalidate
+	struct SPC_PairCache
+	{
+		SPC_PairCache(int capacity = 64);
+
+		//narrowphase through the cache. same result as Collision::Collide, except that a pair whose aabbs did not change
+		//gets the stored manifold back, which is stale if a shape was turned without changing its aabb and not passed to Invalidate
+		bool Collide(SPC_Manifold* m);
+
+		//Collide for each pair, with the same exception. colliding manifolds are moved to the front, keeping their order
+		int CollideAll(SPC_Manifold* pairs, int count);
+
+		//nullptr when the pair is not in the cache
+		SPC_PairCacheEntry* Find(SPC_Shape* a, SPC_Shape* b);
+
+		//remove the pairs which were not used since the last call, and start a new frame
+		void EndFrame();
+
+		//forget the manifolds of the shape, so its pairs run the narrowphase again
+		void Invalidate(SPC_Shape* shape);
+
+		int GetCount() const;
+
+		int GetCapacity() const;
+
+		//pairs which skipped the narrowphase since the last EndFrame
+		int GetHits() const;
+
+		int GetMisses() const;
+
+		void Clear();
+
+	private:
+		std::vector<SPC_PairCacheEntry> entries;
+		std::vector<SPC_PairCacheEntry> live; //scratch for EndFrame
+		int count;
+		int hits;
+		int misses;
+		unsigned int frame;
+
+		unsigned int Hash(SPC_Shape* a, SPC_Shape* b) const;
+
+		SPC_PairCacheEntry* Insert(SPC_Shape* a, SPC_Shape* b);
+
+		void Rehash(int capacity);
+	};
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,320 @@
+#pragma once
+#ifndef __SPC_SIMD__
+#define __SPC_SIMD__
+
+#include <SP2C/SPC_Constants.h>
+
+//vectors of Real for the batch functions. the instruction set is picked from the compiler flags:
+//AVX2 (4 doubles or 8 floats), SSE2 or NEON on 64 bit arm (2 doubles or 4 floats), or plain Real (1 lane).
+//define SP2C_NO_AVX2 to stay on SSE2, or SP2C_NO_SIMD for the scalar version.
+//every function is the same IEEE operation as the scalar one, so each level gives the same results.
+//with fused multiply-add enabled (-mfma), build with -ffp-contract=off to keep it that way
+
+#if !defined(SP2C_NO_SIMD) && !defined(SP2C_NO_AVX2) && defined(__AVX2__)
+#define SP2C_SIMD_AVX2
+#include <immintrin.h>
+#elif !defined(SP2C_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define SP2C_SIMD_SSE2
+#include <emmintrin.h>
+#elif !defined(SP2C_NO_SIMD) && defined(__ARM_NEON) && defined(__aarch64__)
+#define SP2C_SIMD_NEON
+#include <arm_neon.h>
+#else
+#define SP2C_SIMD_SCALAR
+#include <cmath>
+#endif
+
+namespace SP2C
+{
+	namespace SIMD
+	{
+#if defined(SP2C_SIMD_AVX2) && !defined(SP2C_USE_FLOAT)
+		typedef __m256d Vector;
+		typedef __m256d Mask;
+		const int WIDTH = 4;
+
+		inline Vector Load(const Real* p) { return _mm256_loadu_pd(p); }
+		inline void Store(Real* p, Vector a) { _mm256_storeu_pd(p, a); }
+		inline Vector Set(Real k) { return _mm256_set1_pd(k); }
+
+		//x and y lanes from WIDTH (x, y) pairs in a row, as in an array of Vec2
+		inline void LoadPairs(const Real* p, Vector* x, Vector* y)
+		{
+			__m256d a = _mm256_loadu_pd(p), b = _mm256_loadu_pd(p + 4);
+			*x = _mm256_permute4x64_pd(_mm256_unpacklo_pd(a, b), 0xD8); //(x0, x2, x1, x3) to (x0, x1, x2, x3)
+			*y = _mm256_permute4x64_pd(_mm256_unpackhi_pd(a, b), 0xD8);
+		}
+
+		//back to (x, y) pairs, the reverse of LoadPairs
+		inline void StorePairs(Real* p, Vector x, Vector y)
+		{
+			__m256d lo = _mm256_unpacklo_pd(x, y), hi = _mm256_unpackhi_pd(x, y); //(x0, y0, x2, y2), (x1, y1, x3, y3)
+			_mm256_storeu_pd(p, _mm256_permute2f128_pd(lo, hi, 0x20));
+			_mm256_storeu_pd(p + 4, _mm256_permute2f128_pd(lo, hi, 0x31));
+		}
+
+		inline Vector Add(Vector a, Vector b) { return _mm256_add_pd(a, b); }
+		inline Vector Sub(Vector a, Vector b) { return _mm256_sub_pd(a, b); }
+		inline Vector Mul(Vector a, Vector b) { return _mm256_mul_pd(a, b); }
+		inline Vector Div(Vector a, Vector b) { return _mm256_div_pd(a, b); }
+		inline Vector Sqrt(Vector a) { return _mm256_sqrt_pd(a); }
+
+		inline Mask Less(Vector a, Vector b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+		inline Mask Greater(Vector a, Vector b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+		inline Mask Equal(Vector a, Vector b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+		inline Mask NotGreater(Vector a, Vector b) { return _mm256_cmp_pd(a, b, _CMP_NGT_UQ); } //!(a > b), true for NaN
+
+		inline Mask Or(Mask a, Mask b) { return _mm256_or_pd(a, b); }
+		inline Mask And(Mask a, Mask b) { return _mm256_and_pd(a, b); }
+
+		//a where the mask is set, b elsewhere
+		inline Vector Select(Mask m, Vector a, Vector b) { return _mm256_blendv_pd(b, a, m); }
+
+		//bit i is set when lane i of the mask is set
+		inline int MoveMask(Mask m) { return _mm256_movemask_pd(m); }
+#elif defined(SP2C_SIMD_AVX2)
+		typedef __m256 Vector;
+		typedef __m256 Mask;
+		const int WIDTH = 8;
+
+		inline Vector Load(const Real* p) { return _mm256_loadu_ps(p); }
+		inline void Store(Real* p, Vector a) { _mm256_storeu_ps(p, a); }
+		inline Vector Set(Real k) { return _mm256_set1_ps(k); }
+
+		inline void LoadPairs(const Real* p, Vector* x, Vector* y)
+		{
+			__m256 a = _mm256_loadu_ps(p), b = _mm256_loadu_ps(p + 8);
+
+			//(x0, x1, x4, x5, x2, x3, x6, x7) to (x0, ..., x7) by moving pairs of floats
+			__m256 lo = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+			__m256 hi = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+			*x = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(lo), 0xD8));
+			*y = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(hi), 0xD8));
+		}
+
+		inline void StorePairs(Real* p, Vector x, Vector y)
+		{
+			__m256 lo = _mm256_unpacklo_ps(x, y), hi = _mm256_unpackhi_ps(x, y);
+			_mm256_storeu_ps(p, _mm256_permute2f128_ps(lo, hi, 0x20));
+			_mm256_storeu_ps(p + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+		}
+
+		inline Vector Add(Vector a, Vector b) { return _mm256_add_ps(a, b); }
+		inline Vector Sub(Vector a, Vector b) { return _mm256_sub_ps(a, b); }
+		inline Vector Mul(Vector a, Vector b) { return _mm256_mul_ps(a, b); }
+		inline Vector Div(Vector a, Vector b) { return _mm256_div_ps(a, b); }
+		inline Vector Sqrt(Vector a) { return _mm256_sqrt_ps(a); }
+
+		inline Mask Less(Vector a, Vector b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+		inline Mask Greater(Vector a, Vector b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+		inline Mask Equal(Vector a, Vector b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+		inline Mask NotGreater(Vector a, Vector b) { return _mm256_cmp_ps(a, b, _CMP_NGT_UQ); }
+
+		inline Mask Or(Mask a, Mask b) { return _mm256_or_ps(a, b); }
+		inline Mask And(Mask a, Mask b) { return _mm256_and_ps(a, b); }
+
+		inline Vector Select(Mask m, Vector a, Vector b) { return _mm256_blendv_ps(b, a, m); }
+
+		inline int MoveMask(Mask m) { return _mm256_movemask_ps(m); }
+#elif defined(SP2C_SIMD_SSE2) && !defined(SP2C_USE_FLOAT)
+		typedef __m128d Vector;
+		typedef __m128d Mask;
+		const int WIDTH = 2;
+
+		inline Vector Load(const Real* p) { return _mm_loadu_pd(p); }
+		inline void Store(Real* p, Vector a) { _mm_storeu_pd(p, a); }
+		inline Vector Set(Real k) { return _mm_set1_pd(k); }
+
+		inline void LoadPairs(const Real* p, Vector* x, Vector* y)
+		{
+			__m128d a = _mm_loadu_pd(p), b = _mm_loadu_pd(p + 2);
+			*x = _mm_unpacklo_pd(a, b);
+			*y = _mm_unpackhi_pd(a, b);
+		}
+
+		inline void StorePairs(Real* p, Vector x, Vector y)
+		{
+			_mm_storeu_pd(p, _mm_unpacklo_pd(x, y));
+			_mm_storeu_pd(p + 2, _mm_unpackhi_pd(x, y));
+		}
+
+		inline Vector Add(Vector a, Vector b) { return _mm_add_pd(a, b); }
+		inline Vector Sub(Vector a, Vector b) { return _mm_sub_pd(a, b); }
+		inline Vector Mul(Vector a, Vector b) { return _mm_mul_pd(a, b); }
+		inline Vector Div(Vector a, Vector b) { return _mm_div_pd(a, b); }
+		inline Vector Sqrt(Vector a) { return _mm_sqrt_pd(a); }
+
+		inline Mask Less(Vector a, Vector b) { return _mm_cmplt_pd(a, b); }
+		inline Mask Greater(Vector a, Vector b) { return _mm_cmpgt_pd(a, b); }
+		inline Mask Equal(Vector a, Vector b) { return _mm_cmpeq_pd(a, b); }
+		inline Mask NotGreater(Vector a, Vector b) { return _mm_cmpngt_pd(a, b); }
+
+		inline Mask Or(Mask a, Mask b) { return _mm_or_pd(a, b); }
+		inline Mask And(Mask a, Mask b) { return _mm_and_pd(a, b); }
+
+		inline Vector Select(Mask m, Vector a, Vector b) { return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b)); }
+
+		inline int MoveMask(Mask m) { return _mm_movemask_pd(m); }
+#elif defined(SP2C_SIMD_SSE2)
+		typedef __m128 Vector;
+		typedef __m128 Mask;
+		const int WIDTH = 4;
+
+		inline Vector Load(const Real* p) { return _mm_loadu_ps(p); }
+		inline void Store(Real* p, Vector a) { _mm_storeu_ps(p, a); }
+		inline Vector Set(Real k) { return _mm_set1_ps(k); }
+
+		inline void LoadPairs(const Real* p, Vector* x, Vector* y)
+		{
+			__m128 a = _mm_loadu_ps(p), b = _mm_loadu_ps(p + 4);
+			*x = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+			*y = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+		}
+
+		inline void StorePairs(Real* p, Vector x, Vector y)
+		{
+			_mm_storeu_ps(p, _mm_unpacklo_ps(x, y));
+			_mm_storeu_ps(p + 4, _mm_unpackhi_ps(x, y));
+		}
+
+		inline Vector Add(Vector a, Vector b) { return _mm_add_ps(a, b); }
+		inline Vector Sub(Vector a, Vector b) { return _mm_sub_ps(a, b); }
+		inline Vector Mul(Vector a, Vector b) { return _mm_mul_ps(a, b); }
+		inline Vector Div(Vector a, Vector b) { return _mm_div_ps(a, b); }
+		inline Vector Sqrt(Vector a) { return _mm_sqrt_ps(a); }
+
+		inline Mask Less(Vector a, Vector b) { return _mm_cmplt_ps(a, b); }
+		inline Mask Greater(Vector a, Vector b) { return _mm_cmpgt_ps(a, b); }
+		inline Mask Equal(Vector a, Vector b) { return _mm_cmpeq_ps(a, b); }
+		inline Mask NotGreater(Vector a, Vector b) { return _mm_cmpngt_ps(a, b); }
+
+		inline Mask Or(Mask a, Mask b) { return _mm_or_ps(a, b); }
+		inline Mask And(Mask a, Mask b) { return _mm_and_ps(a, b); }
+
+		inline Vector Select(Mask m, Vector a, Vector b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+
+		inline int MoveMask(Mask m) { return _mm_movemask_ps(m); }
+#elif defined(SP2C_SIMD_NEON) && !defined(SP2C_USE_FLOAT)
+		typedef float64x2_t Vector;
+		typedef uint64x2_t Mask;
+		const int WIDTH = 2;
+
+		inline Vector Load(const Real* p) { return vld1q_f64(p); }
+		inline void Store(Real* p, Vector a) { vst1q_f64(p, a); }
+		inline Vector Set(Real k) { return vdupq_n_f64(k); }
+
+		inline void LoadPairs(const Real* p, Vector* x, Vector* y)
+		{
+			float64x2x2_t v = vld2q_f64(p);
+			*x = v.val[0];
+			*y = v.val[1];
+		}
+
+		inline void StorePairs(Real* p, Vector x, Vector y)
+		{
+			float64x2x2_t v = { { x, y } };
+			vst2q_f64(p, v);
+		}
+
+		inline Vector Add(Vector a, Vector b) { return vaddq_f64(a, b); }
+		inline Vector Sub(Vector a, Vector b) { return vsubq_f64(a, b); }
+		inline Vector Mul(Vector a, Vector b) { return vmulq_f64(a, b); }
+		inline Vector Div(Vector a, Vector b) { return vdivq_f64(a, b); }
+		inline Vector Sqrt(Vector a) { return vsqrtq_f64(a); }
+
+		inline Mask Less(Vector a, Vector b) { return vcltq_f64(a, b); }
+		inline Mask Greater(Vector a, Vector b) { return vcgtq_f64(a, b); }
+		inline Mask Equal(Vector a, Vector b) { return vceqq_f64(a, b); }
+		inline Mask NotGreater(Vector a, Vector b) { return veorq_u64(vcgtq_f64(a, b), vdupq_n_u64(~0ull)); }
+
+		inline Mask Or(Mask a, Mask b) { return vorrq_u64(a, b); }
+		inline Mask And(Mask a, Mask b) { return vandq_u64(a, b); }
+
+		inline Vector Select(Mask m, Vector a, Vector b) { return vbslq_f64(m, a, b); }
+
+		inline int MoveMask(Mask m) { return (int)(vgetq_lane_u64(m, 0) & 1) | (int)(vgetq_lane_u64(m, 1) & 1) << 1; }
+#elif defined(SP2C_SIMD_NEON)
+		typedef float32x4_t Vector;
+		typedef uint32x4_t Mask;
+		const int WIDTH = 4;
+
+		inline Vector Load(const Real* p) { return vld1q_f32(p); }
+		inline void Store(Real* p, Vector a) { vst1q_f32(p, a); }
+		inline Vector Set(Real k) { return vdupq_n_f32(k); }
+
+		inline void LoadPairs(const Real* p, Vector* x, Vector* y)
+		{
+			float32x4x2_t v = vld2q_f32(p);
+			*x = v.val[0];
+			*y = v.val[1];
+		}
+
+		inline void StorePairs(Real* p, Vector x, Vector y)
+		{
+			float32x4x2_t v = { { x, y } };
+			vst2q_f32(p, v);
+		}
+
+		inline Vector Add(Vector a, Vector b) { return vaddq_f32(a, b); }
+		inline Vector Sub(Vector a, Vector b) { return vsubq_f32(a, b); }
+		inline Vector Mul(Vector a, Vector b) { return vmulq_f32(a, b); }
+		inline Vector Div(Vector a, Vector b) { return vdivq_f32(a, b); }
+		inline Vector Sqrt(Vector a) { return vsqrtq_f32(a); }
+
+		inline Mask Less(Vector a, Vector b) { return vcltq_f32(a, b); }
+		inline Mask Greater(Vector a, Vector b) { return vcgtq_f32(a, b); }
+		inline Mask Equal(Vector a, Vector b) { return vceqq_f32(a, b); }
+		inline Mask NotGreater(Vector a, Vector b) { return vmvnq_u32(vcgtq_f32(a, b)); }
+
+		inline Mask Or(Mask a, Mask b) { return vorrq_u32(a, b); }
+		inline Mask And(Mask a, Mask b) { return vandq_u32(a, b); }
+
+		inline Vector Select(Mask m, Vector a, Vector b) { return vbslq_f32(m, a, b); }
+
+		inline int MoveMask(Mask m)
+		{
+			return (int)(vgetq_lane_u32(m, 0) & 1) | (int)(vgetq_lane_u32(m, 1) & 1) << 1 |
+				(int)(vgetq_lane_u32(m, 2) & 1) << 2 | (int)(vgetq_lane_u32(m, 3) & 1) << 3;
+		}
+#else
+		typedef Real Vector;
+		typedef bool Mask;
+		const int WIDTH = 1;
+
+		inline Vector Load(const Real* p) { return *p; }
+		inline void Store(Real* p, Vector a) { *p = a; }
+		inline Vector Set(Real k) { return k; }
+
+		inline void LoadPairs(const Real* p, Vector* x, Vector* y)
+		{
+			*x = p[0];
+			*y = p[1];
+		}
+
+		inline void StorePairs(Real* p, Vector x, Vector y)
+		{
+			p[0] = x;
+			p[1] = y;
+		}
+
+		inline Vector Add(Vector a, Vector b) { return a + b; }
+		inline Vector Sub(Vector a, Vector b) { return a - b; }
+		inline Vector Mul(Vector a, Vector b) { return a * b; }
+		inline Vector Div(Vector a, Vector b) { return a / b; }
+		inline Vector Sqrt(Vector a) { return std::sqrt(a); }
+
+		inline Mask Less(Vector a, Vector b) { return a < b; }
+		inline Mask Greater(Vector a, Vector b) { return a > b; }
+		inline Mask Equal(Vector a, Vector b) { return a == b; }
+		inline Mask NotGreater(Vector a, Vector b) { return !(a > b); }
+
+		inline Mask Or(Mask a, Mask b) { return a || b; }
+		inline Mask And(Mask a, Mask b) { return a && b; }
+
+		inline Vector Select(Mask m, Vector a, Vector b) { return m ? a : b; }
+
+		inline int MoveMask(Mask m) { return m ? 1 : 0; }
+#endif
+	}
+}
+#endif
\ No newline at end of file
@@ -4,9 +4,12 @@
 
 #include <cassert>
 #include <algorithm>
+#include <variant>
 #include <SP2C/SPC_Vector.h>
 #include <SP2C/SPC_Math.h>
 #include <SP2C/SPC_Mat33.h>
+#include <SP2C/SPC_Mat23.h>
+#include <SP2C/SPC_Transform.h>
 
 namespace SP2C
 {
@@ -20,11 +23,13 @@ namespace SP2C
 
 		ShapeType type;
 
+		virtual ~SPC_Shape() {}
+
 		virtual SPC_Shape* Clone() const = 0;
-		virtual void Translate(double x, double y) {}
+		virtual void Translate(Real x, Real y) {}
 		virtual void Translate(Vec2 p) {}
-		virtual void Scale(double k) {}
-		virtual void Rotate(double deg) {}
+		virtual void Scale(Real k) {}
+		virtual void Rotate(Real deg) {}
 		virtual void Transform(SPC_Mat33 matrix) {}
 	};
 
@@ -50,13 +55,13 @@ namespace SP2C
 		void GetVertices(Vec2* vertices) const;
 
 		//set aabb vertices with size. top left is (0, 0)
-		void SetBox(double w, double h);
+		void SetBox(Real w, Real h);
 
-		void Translate(double x, double y) override;
+		void Translate(Real x, Real y) override;
 
 		void Translate(Vec2 p) override;
 
-		void Scale(double k) override;
+		void Scale(Real k) override;
 
 		void Transform(SPC_Mat33 matrix) override;
 
@@ -75,14 +80,14 @@ namespace SP2C
 
 	SPC_AABB CombineAABB(SPC_AABB a, SPC_AABB b);
 
-	double GetArea(SPC_AABB a);
+	Real GetArea(SPC_AABB a);
 
 	struct SPC_Circle : public SPC_Shape
 	{
-		double radius;
+		Real radius;
 		Vec2 position;
 
-		SPC_Circle(double r = 0, Vec2 p = Vec2(0, 0));
+		SPC_Circle(Real r = 0, Vec2 p = Vec2(0, 0));
 
 		SPC_Circle(const SPC_Circle& circle);
 
@@ -90,11 +95,11 @@ namespace SP2C
 
 		SPC_AABB ComputeAABB() const;
 
-		void Translate(double x, double y) override;
+		void Translate(Real x, Real y) override;
 
 		void Translate(Vec2 p) override;
 
-		void Scale(double k) override;
+		void Scale(Real k) override;
 
 		void Transform(SPC_Mat33 matrix) override;
 
@@ -102,42 +107,99 @@ namespace SP2C
 
 	};
 
+	//vertices and normals point to arrays inside the polygon for up to INLINE_POLY vertices.
+	//bigger polygons take a block from a pool shared by all polygons, returned when the polygon is destroyed
 	struct SPC_Polygon : public SPC_Shape
 	{
-		static const int MAX_POLY = 64;
-		Vec2 vertices[MAX_POLY];
-		Vec2 normals[MAX_POLY];
+		static const unsigned int INLINE_POLY = 8;
+		static const unsigned int STACK_POLY = 64; //the narrowphase keeps temporary copies of up to this many vertices on the stack
+		Vec2* vertices;
+		Vec2* normals;
 		unsigned int vertexCount;
 
 		SPC_Polygon();
 
 		SPC_Polygon(const SPC_Polygon& polygon);
 
+		~SPC_Polygon();
+
 		SPC_Shape* Clone() const override;
 
 		Vec2 GetCenter();
 
-		//set polygon vertices from vector array. result is a convex hull. you can set vertices directly with ordering=false
+		//set polygon vertices from vector array. result is a convex hull. you can set vertices directly with ordering=false.
+		//v can't be the vertices of this polygon
 		void Set(Vec2* v, unsigned int count, bool ordering = true);
 
+		//make room for count vertices. vertices and normals are kept only when they already fit (no reallocation)
+		void Reserve(unsigned int count);
+
+		unsigned int GetCapacity() const;
+
 		//set polygon vertices with size. top left is (0, 0)
-		void SetBox(double w, double h);
+		void SetBox(Real w, Real h);
 
-		void Translate(double x, double y) override;
+		void Translate(Real x, Real y) override;
 
 		void Translate(Vec2 p) override;
 
-		void Scale(double k) override;
+		void Scale(Real k) override;
 
-		void Rotate(double deg) override;
+		void Rotate(Real deg) override;
 		 
 		void Transform(SPC_Mat33 matrix) override;
 
+		//for rigid transforms. vertices and normals are moved by the batch functions, and the normals are turned, not computed again
+		void Transform(const SPC_Mat23& matrix);
+
 		SPC_AABB ComputeAABB() const;
 
 		SPC_Polygon& operator=(const SPC_Polygon& polygon);
+
+	private:
+		unsigned int capacity;
+		Vec2 inlineVertices[INLINE_POLY];
+		Vec2 inlineNormals[INLINE_POLY];
 	};
 	
+	//a shape held by value, for Collision::Collide with std::visit. a new shape type goes in a variant of its own with these
+	typedef std::variant<SPC_AABB, SPC_Circle, SPC_Polygon> SPC_ShapeVariant;
+
+	inline SPC_Shape* GetShape(SPC_ShapeVariant& shape)
+	{
+		return std::visit([](SPC_Shape& s) { return &s; }, shape);
+	}
+
 	SPC_AABB ComputeAABB(SPC_Shape* shape);
+
+	//aabb of a shape in local space placed by t. an aabb under a turned transform is a box
+	SPC_AABB ComputeAABB(SPC_Shape* shape, const SPC_Transform2D& t);
+
+	//a shape in local space placed in the world by a transform, without a copy. the view doesn't own the shape, which must outlive it.
+	//many views can share one shape, and moving a view changes only its transform
+	struct SPC_ShapeView
+	{
+		SPC_Shape* shape;
+		SPC_Transform2D transform;
+
+		constexpr SPC_ShapeView() : shape(nullptr), transform()
+		{
+		}
+
+		constexpr SPC_ShapeView(SPC_Shape* shape, const SPC_Transform2D& transform) : shape(shape), transform(transform)
+		{
+		}
+
+		//moved by offset, not turned
+		constexpr SPC_ShapeView(SPC_Shape* shape, Vec2 offset) : shape(shape), transform()
+		{
+			transform.position = offset;
+		}
+	};
+
+	inline SPC_AABB ComputeAABB(const SPC_ShapeView& view)
+	{
+		return ComputeAABB(view.shape, view.transform);
+	}
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,98 @@
+#pragma once
+#ifndef __SPC_STATICBVH__
+#define __SPC_STATICBVH__
+
+#include <vector>
+#include <SP2C/SPC_Vector.h>
+#include <SP2C/SPC_Shapes.h>
+#include <SP2C/SPC_Manifold.h>
+#include <SP2C/SPC_Broadphase.h>
+#include <SP2C/SPC_DynamicTree.h>
+#include <SP2C/SPC_Batch.h>
+
+namespace SP2C
+{
+	struct SPC_BVHNode
+	{
+		Vec2 min;
+		Vec2 max;
+		int escape; //next node to visit when this subtree is skipped
+		int start; //first primitive of a leaf
+		int count; //primitive count of a leaf. 0 for branches
+	};
+
+	struct SPC_BVHPrimitive
+	{
+		Vec2 min;
+		Vec2 max;
+		SPC_Shape* shape;
+		int index; //index in the array given to Build
+	};
+
+	//bvh for shapes which never move, built at once from an array.
+	//nodes are stored in depth first order (the left child follows its parent), and each node knows
+	//where its subtree ends, so queries walk the array without recursion or a stack
+	struct SPC_StaticBVH
+	{
+		enum BuildMethod
+		{
+			BinnedSAH = 0, //binned surface area heuristic. better trees
+			Morton //linear bvh from sorted morton codes of the centers. faster builds
+		};
+
+		static const int BIN_COUNT = 16;
+		static const int MAX_LEAF_SIZE = 8;
+
+		std::vector<SPC_BVHNode> nodes;
+		std::vector<SPC_BVHPrimitive> primitives; //ordered by leaf
+
+		SPC_StaticBVH();
+
+		void Build(SPC_Shape** shapes, int count, BuildMethod method = BinnedSAH, int leafSize = 2);
+
+		//report shapes whose aabbs overlap the query aabb. proxy id is the index given to Build
+		void Query(SPC_AABB aabb, SPC_QueryCallback callback, void* data) const;
+
+		//report pairs of a dynamic shape (A) and a static shape (B) whose aabbs overlap
+		void QueryPairs(SPC_Shape** shapes, int count, SPC_PairCallback callback, void* data) const;
+
+		//same with the fat aabbs of the proxies in a dynamic tree
+		void QueryPairs(const SPC_DynamicTree& tree, SPC_PairCallback callback, void* data) const;
+
+		//report the shapes whose aabbs the ray crosses. see SPC_RayCallback
+		void Raycast(Vec2 origin, Vec2 dir, Real maxT, SPC_RayCallback callback, void* data) const;
+
+		//cast the ray against the shapes. returns the number of hits, and only the first capacity are written
+		int Raycast(Vec2 origin, Vec2 dir, Real maxT, SPC_RaycastMode mode, SPC_RaycastHit* hits, int capacity) const;
+
+		int GetNodeCount() const;
+
+		int GetDepth() const;
+
+		//expected cost of a query by the surface area heuristic. lower is better
+		Real GetSAHCost() const;
+
+		void Clear();
+
+	private:
+		int leafSize;
+		std::vector<unsigned int> codes;
+
+		//bounds of the primitives by component, for the batch test of a whole leaf.
+		//padded by SIMD::WIDTH - 1, so the last vector of the last leaf can be loaded
+		std::vector<Real> boundsMinX;
+		std::vector<Real> boundsMinY;
+		std::vector<Real> boundsMaxX;
+		std::vector<Real> boundsMaxY;
+
+		int BuildSAH(int begin, int end);
+
+		int BuildMorton(int begin, int end);
+
+		int MakeNode(int begin, int end, bool leaf);
+
+		template <typename Callback>
+		void Traverse(Vec2 min, Vec2 max, Callback& callback) const;
+	};
+}
+#endif
\ No newline at end of file
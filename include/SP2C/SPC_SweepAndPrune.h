@@ -0,0 +1,108 @@
+#pragma once
+#ifndef __SPC_SWEEPANDPRUNE__
+#define __SPC_SWEEPANDPRUNE__
+
+#include <vector>
+#include <SP2C/SPC_Vector.h>
+#include <SP2C/SPC_Shapes.h>
+#include <SP2C/SPC_Manifold.h>
+#include <SP2C/SPC_Broadphase.h>
+
+namespace SP2C
+{
+	struct SPC_ThreadPool;
+
+	struct SPC_SweepProxy
+	{
+		SPC_AABB aabb;
+		SPC_Shape* shape;
+		int next; //next free proxy when the proxy is not used
+		bool used;
+	};
+
+	struct SPC_SweepEntry
+	{
+		Real min; //endpoints on the sweep axis
+		Real max;
+		int proxyId;
+	};
+
+	//sort and sweep on one axis. the sorted order is kept between frames, so it is updated with insertion sort
+	//in near linear time when shapes move a little
+	struct SPC_SweepAndPrune
+	{
+		enum SweepAxis
+		{
+			AxisX = 0, AxisY, AxisAuto //auto picks the axis with the largest variance of the centers
+		};
+
+		std::vector<SPC_SweepProxy> proxies;
+		std::vector<SPC_SweepEntry> entries; //sorted by min on the sweep axis
+		int freeList;
+		int proxyCount;
+
+		SweepAxis mode;
+		int axis; //current sweep axis. 0 = x, 1 = y
+
+		SPC_SweepAndPrune(SweepAxis mode = AxisX);
+
+		//replace the proxies with the shapes of the array. proxy id is the array index.
+		//the sorted order and the buffers are kept, so calling it every frame with the same array doesn't allocate
+		void Set(SPC_Shape** shapes, int count);
+
+		//same, with the aabbs computed by the workers of the pool
+		void Set(SPC_Shape** shapes, int count, SPC_ThreadPool& pool);
+
+		int CreateProxy(SPC_Shape* shape);
+
+		int CreateProxy(const SPC_AABB& aabb, SPC_Shape* shape);
+
+		void DestroyProxy(int proxyId);
+
+		void MoveProxy(int proxyId, const SPC_AABB& aabb);
+
+		//recompute the aabb from the shape of the proxy
+		void UpdateProxy(int proxyId);
+
+		//recompute the aabbs of all proxies
+		void UpdateAll();
+
+		SPC_Shape* GetShape(int proxyId) const;
+
+		const SPC_AABB& GetAABB(int proxyId) const;
+
+		//refresh the endpoints and sort them. called by the queries
+		void Sort();
+
+		void Query(SPC_AABB aabb, SPC_QueryCallback callback, void* data);
+
+		//report every pair of proxies whose aabbs overlap, each pair once. A has the smaller proxy id
+		void QueryPairs(SPC_PairCallback callback, void* data);
+
+		//the sweep is split among the workers of the pool. pairs are reported on the calling thread,
+		//in the same order as the single threaded query
+		void QueryPairs(SPC_PairCallback callback, void* data, SPC_ThreadPool& pool);
+
+		void Clear();
+
+	private:
+		static const int MIN_CHUNK_SIZE = 256;
+
+		bool sorted; //false when the order of the entries is unknown
+		std::vector<std::vector<int>> chunkPairs; //proxy id pairs found by each chunk of the parallel sweep
+
+		void SetLayout(int count);
+
+		int ChooseAxis() const;
+
+		template <typename Report>
+		void Sweep(unsigned int begin, unsigned int end, Report& report);
+
+		//sweep one chunk of the entries for the parallel query
+		void SweepChunk(int chunk, int chunkCount);
+
+		//pool callback of the parallel query, data is the job
+		static void SweepTask(int task, int worker, void* data);
+	};
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,84 @@
+#pragma once
+#ifndef __SPC_THREADPOOL__
+#define __SPC_THREADPOOL__
+
+#include <cassert>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+namespace SP2C
+{
+	//task is the index of the task, worker is the index of the thread running it (0 is the calling thread)
+	typedef void (*SPC_TaskCallback) (int task, int worker, void* data);
+
+	struct SPC_WorkerStats
+	{
+		long long tasks; //tasks run by the worker
+		long long steals; //successful steals from other workers
+		long long failedSteals; //times the worker ran out of tasks and found every other queue empty, once per idle period
+		double idleSeconds; //time spent waiting for the last tasks of a run
+	};
+
+	struct SPC_WorkerQueue
+	{
+		std::mutex mutex;
+		std::vector<int> tasks;
+		int head; //the owner takes from the head
+		int tail; //thieves take from the tail
+	};
+
+	//fixed set of worker threads with a work stealing scheduler. Run blocks until every task is done, and the calling thread takes tasks too.
+	//tasks are split into contiguous blocks of equal cost, one per worker queue. a worker runs its block in order,
+	//then steals the back half of the fullest queue it finds
+	struct SPC_ThreadPool
+	{
+		//threadCount is the number of workers including the calling thread. 0 uses every hardware thread
+		SPC_ThreadPool(int threadCount = 0);
+
+		~SPC_ThreadPool();
+
+		SPC_ThreadPool(const SPC_ThreadPool&) = delete;
+
+		SPC_ThreadPool& operator=(const SPC_ThreadPool&) = delete;
+
+		int GetWorkerCount() const;
+
+		//costs are relative costs of the tasks, used for the first distribution. nullptr means equal costs
+		void Run(int taskCount, SPC_TaskCallback callback, void* data, const double* costs = nullptr);
+
+		//stats are summed over runs until reset
+		const SPC_WorkerStats& GetStats(int worker) const;
+
+		SPC_WorkerStats GetTotalStats() const;
+
+		void ResetStats();
+
+	private:
+		std::vector<std::thread> threads;
+		std::vector<SPC_WorkerQueue> queues;
+		std::vector<SPC_WorkerStats> stats;
+
+		std::mutex mutex;
+		std::condition_variable start;
+		std::condition_variable finish;
+
+		SPC_TaskCallback callback;
+		void* data;
+		std::atomic<int> remainingTasks;
+		int activeWorkers; //workers between picking up a run and reporting it
+		unsigned int generation;
+		bool stop;
+
+		void WorkerLoop(int worker);
+
+		void Work(int worker);
+
+		bool Pop(int worker, int* task);
+
+		bool Steal(int worker);
+	};
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,93 @@
+#pragma once
+#ifndef __SPC_TRANSFORM__
+#define __SPC_TRANSFORM__
+
+#include <cmath>
+#include <SP2C/SPC_Constants.h>
+#include <SP2C/SPC_Vector.h>
+
+namespace SP2C
+{
+	//position and rotation of a shape whose vertices stay in local space. cos and sin are computed when the rotation is set,
+	//so moving or turning the shape doesn't touch its vertices. a vertex v is at position + R * v in the world
+	struct SPC_Transform2D
+	{
+		Vec2 position;
+		Real cos;
+		Real sin;
+
+		constexpr SPC_Transform2D() : position(0, 0), cos(1), sin(0)
+		{
+		}
+
+		SPC_Transform2D(Vec2 position, Real deg = 0) : position(position), cos(1), sin(0)
+		{
+			SetRotation(deg);
+		}
+
+		void SetRotation(Real deg)
+		{
+			Real rad = deg * Const::RAD;
+			cos = std::cos(rad);
+			sin = std::sin(rad);
+		}
+
+		//in degrees, from atan2
+		Real GetRotation() const
+		{
+			return std::atan2(sin, cos) / Const::RAD;
+		}
+
+		constexpr void Translate(Vec2 p)
+		{
+			position += p;
+		}
+
+		//turn about position. repeated turns add up rounding errors in cos and sin, SetRotation doesn't
+		void Rotate(Real deg)
+		{
+			Real rad = deg * Const::RAD;
+			Real c = std::cos(rad), s = std::sin(rad);
+
+			Real nextCos = c * cos - s * sin;
+			sin = s * cos + c * sin;
+			cos = nextCos;
+		}
+
+		//local to world
+		constexpr Vec2 Apply(Vec2 v) const
+		{
+			return Vec2(cos * v.x - sin * v.y + position.x, sin * v.x + cos * v.y + position.y);
+		}
+
+		constexpr Vec2 ApplyRotation(Vec2 v) const
+		{
+			return Vec2(cos * v.x - sin * v.y, sin * v.x + cos * v.y);
+		}
+
+		//world to local
+		constexpr Vec2 ApplyInverse(Vec2 v) const
+		{
+			Real x = v.x - position.x, y = v.y - position.y;
+			return Vec2(cos * x + sin * y, -sin * x + cos * y);
+		}
+
+		constexpr Vec2 ApplyInverseRotation(Vec2 v) const
+		{
+			return Vec2(cos * v.x + sin * v.y, -sin * v.x + cos * v.y);
+		}
+	};
+
+	//b in the space of a: Relative(a, b).Apply(v) is a.ApplyInverse(b.Apply(v))
+	constexpr SPC_Transform2D Relative(const SPC_Transform2D& a, const SPC_Transform2D& b)
+	{
+		SPC_Transform2D t;
+		t.cos = a.cos * b.cos + a.sin * b.sin;
+		t.sin = a.cos * b.sin - a.sin * b.cos;
+		t.position = a.ApplyInverse(b.position);
+		return t;
+	}
+
+	constexpr SPC_Transform2D SPC_TRANSFORM_IDENTITY = SPC_Transform2D();
+}
+#endif
\ No newline at end of file
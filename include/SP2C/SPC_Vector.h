@@ -3,49 +3,112 @@
 #define __SP2C_VECTOR__
 
 #include <cmath>
+#include <SP2C/SPC_Constants.h>
 
 namespace SP2C
 {
+	//defined in the header, so the operators inline into the loops of the collision functions
 	struct Vec2
 	{
-		double x;
-		double y;
-
-		Vec2(double x = 0, double y = 0);
-
-		Vec2 operator+(Vec2 a) const;
-
-		Vec2& operator+=(Vec2 a);
-
-		Vec2 operator-(Vec2 a) const;
-
-		Vec2& operator-=(Vec2 a);
-
-		Vec2 operator*(double k) const;
-
-		Vec2& operator*=(double k);
-
-		Vec2 operator/(double k) const;
-
-		Vec2& operator/=(double k);
-
-		bool operator==(Vec2 a) const;
-
-		bool operator!=(Vec2 a) const;
-
-		Vec2 operator-() const;
-
-		double LengthSquared();
-
-		double Length();
-
-		void Normalize();
-
-		bool IsZero() const;
+		Real x;
+		Real y;
+
+		constexpr Vec2(Real x = 0, Real y = 0) : x(x), y(y)
+		{
+		}
+
+		constexpr Vec2 operator+(Vec2 a) const
+		{
+			return { x + a.x, y + a.y };
+		}
+
+		constexpr Vec2& operator+=(Vec2 a)
+		{
+			x += a.x;
+			y += a.y;
+			return *this;
+		}
+
+		constexpr Vec2 operator-(Vec2 a) const
+		{
+			return { x - a.x, y - a.y };
+		}
+
+		constexpr Vec2& operator-=(Vec2 a)
+		{
+			x -= a.x;
+			y -= a.y;
+			return *this;
+		}
+
+		constexpr Vec2 operator*(Real k) const
+		{
+			return { x * k, y * k };
+		}
+
+		constexpr Vec2& operator*=(Real k)
+		{
+			x *= k;
+			y *= k;
+			return *this;
+		}
+
+		constexpr Vec2 operator/(Real k) const
+		{
+			return { x / k, y / k };
+		}
+
+		constexpr Vec2& operator/=(Real k)
+		{
+			x /= k;
+			y /= k;
+			return *this;
+		}
+
+		constexpr bool operator==(Vec2 a) const
+		{
+			return x == a.x && y == a.y;
+		}
+
+		constexpr bool operator!=(Vec2 a) const
+		{
+			return !(*this == a);
+		}
+
+		constexpr Vec2 operator-() const
+		{
+			return { -x, -y };
+		}
+
+		constexpr Real LengthSquared() const
+		{
+			return x * x + y * y;
+		}
+
+		Real Length() const
+		{
+			return std::sqrt(LengthSquared());
+		}
+
+		void Normalize()
+		{
+			Real L = Length();
+			if (L == 0) return;
+			x /= L;
+			y /= L;
+		}
+
+		constexpr bool IsZero() const
+		{
+			return x == 0 && y == 0;
+		}
 	};
 
-	Vec2 operator*(double k, Vec2 v);
+	constexpr Vec2 operator*(Real k, Vec2 v)
+	{
+		return { k * v.x, k * v.y };
+	}
 
-	const Vec2 VEC_ZERO(0, 0);
+	constexpr Vec2 VEC_ZERO(0, 0);
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,151 @@
+#pragma once
+#ifndef __SPC_WORLD__
+#define __SPC_WORLD__
+
+#include <cassert>
+#include <vector>
+#include <SP2C/SPC_Vector.h>
+#include <SP2C/SPC_Shapes.h>
+#include <SP2C/SPC_Manifold.h>
+#include <SP2C/SPC_Collision.h>
+
+namespace SP2C
+{
+	//slot index in the low 24 bits, generation of the slot in the high 8 bits.
+	//a handle of a destroyed shape stays invalid until its slot was reused 256 times
+	typedef unsigned int SPC_Handle;
+
+	const SPC_Handle SPC_NULL_HANDLE = 0xffffffff;
+
+	struct SPC_WorldSlot
+	{
+		unsigned char type; //SPC_Shape::ShapeType, or SPC_Shape::Count when the slot is free
+		unsigned char generation;
+		unsigned int index; //index in the arrays of the type, or the next free slot
+		unsigned int sweep; //index of the sweep item of the shape
+	};
+
+	struct SPC_WorldContact
+	{
+		SPC_Handle A;
+		SPC_Handle B;
+		SPC_Manifold manifold; //manifold.A and manifold.B are nullptr
+	};
+
+	//shapes stored by value in dense arrays, one set per type, and referred to by handles.
+	//circles and aabbs are split by component, polygons keep a range in one vertex pool shared by all of them.
+	//destroying a shape moves the last one of its type in its place, so the arrays never have holes
+	struct SPC_World
+	{
+		static const unsigned int INDEX_BITS = 24;
+		static const unsigned int INDEX_MASK = (1u << INDEX_BITS) - 1;
+
+		//circles
+		std::vector<Real> circleX;
+		std::vector<Real> circleY;
+		std::vector<Real> circleRadius;
+		std::vector<SPC_Handle> circleHandle;
+
+		//aabbs
+		std::vector<Real> boxMinX;
+		std::vector<Real> boxMinY;
+		std::vector<Real> boxMaxX;
+		std::vector<Real> boxMaxY;
+		std::vector<SPC_Handle> boxHandle;
+
+		//polygons. vertices and normals of polygon i are [polygonStart[i], polygonStart[i] + polygonCount[i]) of the pool
+		std::vector<unsigned int> polygonStart;
+		std::vector<unsigned int> polygonCount;
+		std::vector<SPC_Handle> polygonHandle;
+
+		std::vector<Vec2> vertices;
+		std::vector<Vec2> normals;
+
+		SPC_World();
+
+		SPC_Handle CreateCircle(Real radius, Vec2 position);
+
+		SPC_Handle CreateAABB(Vec2 min, Vec2 max);
+
+		//same as SPC_Polygon::Set
+		SPC_Handle CreatePolygon(Vec2* v, unsigned int count, bool ordering = true);
+
+		//copy of the shape
+		SPC_Handle Add(SPC_Shape* shape);
+
+		void Destroy(SPC_Handle handle);
+
+		bool IsValid(SPC_Handle handle) const;
+
+		SPC_Shape::ShapeType GetType(SPC_Handle handle) const;
+
+		//index of the shape in the arrays of its type. it changes when a shape of the same type is destroyed
+		unsigned int GetIndex(SPC_Handle handle) const;
+
+		//same as the functions of the shapes. polygons turn about (0, 0), circles and aabbs don't turn
+		void Translate(SPC_Handle handle, Vec2 p);
+
+		void Scale(SPC_Handle handle, Real k);
+
+		void Rotate(SPC_Handle handle, Real deg);
+
+		//rigid transforms (rotation and translation). circles move their centers, aabbs become the box around their moved corners,
+		//polygons turn their normals
+		void Transform(SPC_Handle handle, const SPC_Mat23& transform);
+
+		//one transform per polygon, in the order of the polygon arrays, by the SIMD batch functions
+		void TransformPolygons(const SPC_Mat23* transforms);
+
+		SPC_AABB ComputeAABB(SPC_Handle handle) const;
+
+		//copies of the shapes
+		SPC_Circle GetCircle(SPC_Handle handle) const;
+
+		SPC_AABB GetAABB(SPC_Handle handle) const;
+
+		SPC_Polygon GetPolygon(SPC_Handle handle) const;
+
+		//same result as Collision::Collide on copies of the shapes
+		bool Collide(SPC_Handle a, SPC_Handle b, SPC_Manifold* m) const;
+
+		bool Collide(SPC_Handle a, SPC_Handle b, SPC_Manifold* m, SPC_SATCache* cache) const;
+
+		//sweep and prune on the x axis, then the narrowphase. the sorted order is kept between calls,
+		//and sorted again from scratch when it is too far from the new one (after creating many shapes).
+		//returns the number of collisions found. only the first capacity contacts are written
+		int CollideAll(SPC_WorldContact* out, int capacity);
+
+		//move the polygons together in the vertex pool. done by Destroy when more than half of the pool is unused
+		void Compact();
+
+		//shapes of every type
+		int GetCount() const;
+
+		int GetCount(SPC_Shape::ShapeType type) const;
+
+		void Clear();
+
+	private:
+		struct SweepItem
+		{
+			Real minX;
+			Real maxX;
+			Real minY;
+			Real maxY;
+			SPC_Handle handle;
+		};
+
+		std::vector<SPC_WorldSlot> slots;
+		unsigned int freeSlot; //first free slot, or INDEX_MASK
+		unsigned int garbage; //unused vertices in the pool
+
+		std::vector<SweepItem> sweep;
+
+		SPC_Handle Allocate(SPC_Shape::ShapeType type, unsigned int index);
+
+		const SPC_WorldSlot& GetSlot(SPC_Handle handle) const;
+
+		void SetIndex(SPC_Handle handle, unsigned int index);
+	};
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,173 @@
+#if !defined(SP2C_SINGLE_TU) || defined(__SPC_UNITY__)
+#include <SP2C/SPC_Batch.h>
+#include <SP2C/SPC_Collision.h>
+
+namespace SP2C
+{
+	//same operations in the same order as SPC_Mat23::operator* and ApplyLinear
+	static void TransformPairs(const SPC_Mat23& transform, Vec2* points, unsigned int count, bool translate)
+	{
+		using namespace SIMD;
+
+		Vector m00 = Set(transform.m[0][0]), m01 = Set(transform.m[0][1]), m02 = Set(transform.m[0][2]);
+		Vector m10 = Set(transform.m[1][0]), m11 = Set(transform.m[1][1]), m12 = Set(transform.m[1][2]);
+
+		unsigned int i = 0;
+		for (; i + WIDTH <= count; i += WIDTH)
+		{
+			Vector x, y;
+			LoadPairs(&points[i].x, &x, &y);
+
+			Vector tx = Add(Mul(m00, x), Mul(m01, y));
+			Vector ty = Add(Mul(m10, x), Mul(m11, y));
+			if (translate)
+			{
+				tx = Add(tx, m02);
+				ty = Add(ty, m12);
+			}
+
+			StorePairs(&points[i].x, tx, ty);
+		}
+
+		for (; i < count; i++)
+			points[i] = translate ? transform * points[i] : transform.ApplyLinear(points[i]);
+	}
+
+	void TransformPoints(const SPC_Mat23& transform, Vec2* points, unsigned int count)
+	{
+		TransformPairs(transform, points, count, true);
+	}
+
+	void TransformVectors(const SPC_Mat23& transform, Vec2* vectors, unsigned int count)
+	{
+		TransformPairs(transform, vectors, count, false);
+	}
+
+	void TransformPolygons(const SPC_Mat23* transforms, const unsigned int* start, const unsigned int* count, int polygons, Vec2* vertices, Vec2* normals)
+	{
+		for (int k = 0; k < polygons; k++)
+		{
+			TransformPairs(transforms[k], vertices + start[k], count[k], true);
+			if (normals)
+				TransformPairs(transforms[k], normals + start[k], count[k], false);
+		}
+	}
+
+	namespace Collision
+	{
+		int Circle_to_Circles(const SPC_Circle& a, const Real* x, const Real* y, const Real* radius, int count, unsigned int* mask,
+			Vec2* normals, Real* penetrations, Vec2* points)
+		{
+			using namespace SIMD;
+
+			for (int w = 0; w < (count + 31) / 32; w++)
+				mask[w] = 0;
+
+			bool contacts = normals || penetrations || points;
+			int hits = 0;
+
+			Vector ax = Set(a.position.x), ay = Set(a.position.y), ar = Set(a.radius);
+			Vector zero = Set(0), one = Set(1);
+
+			//32 is a multiple of the width, so the lanes of a batch are in the same word
+			int i = 0;
+			for (; i + WIDTH <= count; i += WIDTH)
+			{
+				//same operations in the same order as Circle_to_Circle
+				Vector nx = Sub(Load(x + i), ax);
+				Vector ny = Sub(Load(y + i), ay);
+				Vector r = Add(ar, Load(radius + i));
+				Vector d = Add(Mul(nx, nx), Mul(ny, ny));
+
+				int bits = MoveMask(NotGreater(d, Mul(r, r)));
+				if (!bits) continue;
+
+				mask[i >> 5] |= (unsigned int)bits << (i & 31);
+
+				if (!contacts)
+				{
+					for (; bits; bits &= bits - 1)
+						hits++;
+					continue;
+				}
+
+				d = Sqrt(d);
+				Mask centered = Equal(d, zero);
+
+				Vector normalX = Select(centered, one, Div(nx, d));
+				Vector normalY = Select(centered, zero, Div(ny, d));
+
+				Real lanes[5][WIDTH];
+				Store(lanes[0], normalX);
+				Store(lanes[1], normalY);
+				Store(lanes[2], Select(centered, ar, Sub(r, d)));
+				Store(lanes[3], Select(centered, ax, Add(Mul(normalX, ar), ax)));
+				Store(lanes[4], Select(centered, ay, Add(Mul(normalY, ar), ay)));
+
+				for (int k = 0; k < WIDTH; k++)
+				{
+					if (!(bits >> k & 1)) continue;
+					hits++;
+
+					if (normals) normals[i + k] = Vec2(lanes[0][k], lanes[1][k]);
+					if (penetrations) penetrations[i + k] = lanes[2][k];
+					if (points) points[i + k] = Vec2(lanes[3][k], lanes[4][k]);
+				}
+			}
+
+			SPC_Manifold m;
+			for (; i < count; i++)
+			{
+				if (!Circle_to_Circle(a.position, a.radius, Vec2(x[i], y[i]), radius[i], &m))
+					continue;
+
+				mask[i >> 5] |= 1u << (i & 31);
+				hits++;
+
+				if (normals) normals[i] = m.normal;
+				if (penetrations) penetrations[i] = m.penetration;
+				if (points) points[i] = m.contact_points[0];
+			}
+
+			return hits;
+		}
+
+		int AABB_to_AABBs(Vec2 min, Vec2 max, const Real* minX, const Real* minY, const Real* maxX, const Real* maxY, int count, unsigned int* mask)
+		{
+			using namespace SIMD;
+
+			for (int w = 0; w < (count + 31) / 32; w++)
+				mask[w] = 0;
+
+			int hits = 0;
+			Vector x1 = Set(min.x), y1 = Set(min.y), x2 = Set(max.x), y2 = Set(max.y);
+
+			int i = 0;
+			for (; i + WIDTH <= count; i += WIDTH)
+			{
+				Mask apart = Or(Or(Less(x2, Load(minX + i)), Greater(x1, Load(maxX + i))), Or(Less(y2, Load(minY + i)), Greater(y1, Load(maxY + i))));
+
+				unsigned int bits = ~(unsigned int)MoveMask(apart) & ((1u << WIDTH) - 1);
+				mask[i >> 5] |= bits << (i & 31);
+
+				for (; bits; bits &= bits - 1)
+					hits++;
+			}
+
+			for (; i < count; i++)
+			{
+				unsigned int bit = !((max.x < minX[i]) | (min.x > maxX[i]) | (max.y < minY[i]) | (min.y > maxY[i]));
+				mask[i >> 5] |= bit << (i & 31);
+				hits += bit;
+			}
+
+			return hits;
+		}
+
+		int AABB_to_AABBs(const SPC_AABB& a, const Real* minX, const Real* minY, const Real* maxX, const Real* maxY, int count, unsigned int* mask)
+		{
+			return AABB_to_AABBs(a.min, a.max, minX, minY, maxX, maxY, count, mask);
+		}
+	}
+}
+#endif
\ No newline at end of file
@@ -1,41 +1,211 @@
+#if !defined(SP2C_SINGLE_TU) || defined(__SPC_UNITY__)
 #include <SP2C/SPC_Collision.h>
+#include <SP2C/SPC_SweepAndPrune.h>
+#include <SP2C/SPC_ThreadPool.h>
 
 namespace SP2C
 {
+	SPC_SATCache::SPC_SATCache()
+	{
+		face = 0;
+		shape = 0;
+		valid = false;
+	}
+
 	namespace Collision
 	{
-		int Clip(Vec2 n, double c, Vec2* face)
+		static inline SPC_ContactID MakeID(unsigned int reference, unsigned int incident, bool flip, SPC_ContactID::FeatureType type)
+		{
+			SPC_ContactID id;
+			id.reference = (unsigned short)reference;
+			id.incident = (unsigned short)incident;
+			id.flip = flip ? 1 : 0;
+			id.type = (unsigned char)type;
+			return id;
+		}
+
+		//true when the face found by the last test still separates the shapes. the separating axis (from a to b) goes to normal
+		static bool TestCachedAxis(SPC_SATCache* cache, Vec2* a, Vec2* aNormals, unsigned int n, Vec2* b, Vec2* bNormals, unsigned int m, Vec2* normal)
+		{
+			if (!cache || !cache->valid)
+				return false;
+
+			if (cache->shape == 0)
+			{
+				if (cache->face >= n) return false;
+
+				Vec2 axis = aNormals[cache->face];
+				if (DotProduct(axis, GetSupport(-axis, b, bNormals, m) - a[cache->face]) < 0)
+					return false;
+
+				*normal = axis;
+			}
+			else
+			{
+				if (cache->face >= m) return false;
+
+				Vec2 axis = bNormals[cache->face];
+				if (DotProduct(axis, GetSupport(-axis, a, aNormals, n) - b[cache->face]) < 0)
+					return false;
+
+				*normal = -axis;
+			}
+
+			return true;
+		}
+
+		static inline void SetCachedAxis(SPC_SATCache* cache, unsigned int face, unsigned char shape)
+		{
+			if (!cache) return;
+
+			cache->face = face;
+			cache->shape = shape;
+			cache->valid = true;
+		}
+
+		int Clip(Vec2 n, Real c, Vec2* face)
 		{
 			unsigned int sp = 0;
 			Vec2 out[2] = { face[0], face[1] };
 
-			double d1 = DotProduct(n, face[0]) - c;
-			double d2 = DotProduct(n, face[1]) - c;
+			Real d1 = DotProduct(n, face[0]) - c;
+			Real d2 = DotProduct(n, face[1]) - c;
 
 			if (d1 <= 0) out[sp++] = face[0];
 			if (d2 <= 0) out[sp++] = face[1];
 
 			if (d1 * d2 < 0)
 			{
-				double alpha = d1 / (d1 - d2);
+				Real alpha = d1 / (d1 - d2);
+				out[sp++] = face[0] + alpha * (face[1] - face[0]);
+			}
+
+			face[0] = out[0];
+			face[1] = out[1];
+
+			assert(sp != 3);
+			return sp;
+		}
+
+		int Clip(Vec2 n, Real c, Vec2* face, SPC_ContactID* ids, SPC_ContactID clipID)
+		{
+			unsigned int sp = 0;
+			Vec2 out[2] = { face[0], face[1] };
+			SPC_ContactID outIDs[2] = { ids[0], ids[1] };
+
+			Real d1 = DotProduct(n, face[0]) - c;
+			Real d2 = DotProduct(n, face[1]) - c;
+
+			if (d1 <= 0)
+			{
+				outIDs[sp] = ids[0];
+				out[sp++] = face[0];
+			}
+
+			if (d2 <= 0)
+			{
+				outIDs[sp] = ids[1];
+				out[sp++] = face[1];
+			}
+
+			if (d1 * d2 < 0)
+			{
+				Real alpha = d1 / (d1 - d2);
+				outIDs[sp] = clipID;
 				out[sp++] = face[0] + alpha * (face[1] - face[0]);
 			}
 
 			face[0] = out[0];
 			face[1] = out[1];
+			ids[0] = outIDs[0];
+			ids[1] = outIDs[1];
 
 			assert(sp != 3);
 			return sp;
 		}
 
-		double FindAxisLeastPenetration(unsigned int* faceIndex, Vec2* a, Vec2* normals, unsigned int n, Vec2* b, unsigned int m)
+		Real FindAxisLeastPenetration(unsigned int* faceIndex, Vec2* a, Vec2* normals, unsigned int n, Vec2* b, unsigned int m)
+		{
+			using namespace SIMD;
+
+			Real bestDistance = -REAL_MAX;
+			unsigned int bestIndex = n;
+			unsigned int i = 0;
+
+			//SIMD::WIDTH faces of a at once. each vertex of b is tested against all of them, so b needs no rearranging
+			if (n >= (unsigned int)WIDTH)
+			{
+				Vector minus = Set(-1), start = Set(-REAL_MAX);
+				Vector best = start, index = Set(-1);
+
+				for (; i + WIDTH <= n; i += WIDTH)
+				{
+					Vector nx, ny, ax, ay;
+					LoadPairs(&normals[i].x, &nx, &ny);
+					LoadPairs(&a[i].x, &ax, &ay);
+
+					//GetSupport(-normals[i], b, m)
+					Vector dx = Mul(nx, minus), dy = Mul(ny, minus);
+					Vector projection = start, sx = Set(0), sy = Set(0);
+
+					for (unsigned int j = 0; j < m; j++)
+					{
+						Vector bx = Set(b[j].x), by = Set(b[j].y);
+						Vector p = Add(Mul(bx, dx), Mul(by, dy));
+						Mask better = Greater(p, projection);
+
+						projection = Select(better, p, projection);
+						sx = Select(better, bx, sx);
+						sy = Select(better, by, sy);
+					}
+
+					Vector d = Add(Mul(nx, Sub(sx, ax)), Mul(ny, Sub(sy, ay)));
+					Mask better = Greater(d, best);
+
+					best = Select(better, d, best);
+					index = Select(better, Set(i), index);
+				}
+
+				FirstMax(best, index, &bestDistance, &bestIndex);
+			}
+
+			for (; i < n; i++)
+			{
+				Real d = DotProduct(normals[i], GetSupport(-normals[i], b, m) - a[i]);
+
+				if (d > bestDistance)
+				{
+					bestDistance = d;
+					bestIndex = i;
+				}
+			}
+
+			*faceIndex = bestIndex < n ? bestIndex : 0;
+			return bestDistance;
+		}
+
+		Real FindAxisLeastPenetration(unsigned int* faceIndex, Vec2* a, Vec2* normals, unsigned int n, Vec2* b, Vec2* bNormals, unsigned int m)
 		{
-			double bestDistance = -DBL_MAX;
+			if (m <= SUPPORT_SEARCH_THRESHOLD)
+				return FindAxisLeastPenetration(faceIndex, a, normals, n, b, m);
+
+			//the angles are the same for every face of a, so they are computed once. bigger hulls don't fit on the stack,
+			//and GetSupportIndex computes the few angles its search visits instead, so the SAT never allocates
+			Real buffer[SPC_Polygon::STACK_POLY];
+			Real* angles = nullptr;
+			if (m <= SPC_Polygon::STACK_POLY)
+			{
+				angles = buffer;
+				ComputeNormalAngles(bNormals, m, angles);
+			}
+
+			Real bestDistance = -REAL_MAX;
 			unsigned int bestIndex = 0;
 
 			for (unsigned int i = 0; i < n; i++)
 			{
-				double d = DotProduct(normals[i], GetSupport(-normals[i], b, m) - a[i]);
+				Vec2 support = b[GetSupportIndex(-normals[i], b, bNormals, m, angles)];
+				Real d = DotProduct(normals[i], support - a[i]);
 
 				if (d > bestDistance)
 				{
@@ -48,13 +218,13 @@ namespace SP2C
 			return bestDistance;
 		}
 
-		void FindIncidentFace(Vec2* v, Vec2 refNormal, Vec2* incVertices, Vec2* incNormals, unsigned int n)
+		unsigned int FindIncidentFace(Vec2* v, Vec2 refNormal, Vec2* incVertices, Vec2* incNormals, unsigned int n)
 		{
-			int incidentFace = 0;
-			double minDot = DBL_MAX;
+			unsigned int incidentFace = 0;
+			Real minDot = REAL_MAX;
 			for (unsigned int i = 0; i < n; i++)
 			{
-				double dot = DotProduct(refNormal, incNormals[i]);
+				Real dot = DotProduct(refNormal, incNormals[i]);
 				if (dot < minDot)
 				{
 					minDot = dot;
@@ -63,36 +233,42 @@ namespace SP2C
 			}
 
 			v[0] = incVertices[incidentFace];
-			incidentFace = incidentFace + 1 < n ? incidentFace + 1 : 0;
-			v[1] = incVertices[incidentFace];
+			v[1] = incVertices[incidentFace + 1 < n ? incidentFace + 1 : 0];
+			return incidentFace;
 		}
 
 		bool AABB_to_AABB(SPC_AABB& a, SPC_AABB& b)
 		{
-			if (a.max.x < b.min.x || a.min.x > b.max.x) return false;
-			if (a.max.y < b.min.y || a.min.y > b.max.y) return false;
-			return true;
+			SPC_Manifold m;
+			return AABB_to_AABB(a.min, a.max, b.min, b.max, &m, QueryOverlap);
 		}
 
 		bool AABB_to_AABB(SPC_Manifold* m)
 		{
-			SPC_AABB* a = reinterpret_cast<SPC_AABB*>(m->A);
-			SPC_AABB* b = reinterpret_cast<SPC_AABB*>(m->B);
+			return CollidePair<SPC_AABB, SPC_AABB>(m);
+		}
+
+		bool AABB_to_AABB(Vec2 aMin, Vec2 aMax, Vec2 bMin, Vec2 bMax, SPC_Manifold* m, SPC_QueryLevel level)
+		{
 			m->contact_count = 0;
 
-			if (!AABB_to_AABB(*a, *b)) return false;
+			if (aMax.x < bMin.x || aMin.x > bMax.x) return false;
+			if (aMax.y < bMin.y || aMin.y > bMax.y) return false;
 
-			Vec2 n = b->GetCenter() - a->GetCenter();
+			if (level == QueryOverlap)
+				return true;
+
+			Vec2 n = (bMin + bMax) / 2 - (aMin + aMax) / 2;
 
-			double a_extent = (a->max.x - a->min.x) / 2;
-			double b_extent = (b->max.x - b->min.x) / 2;
+			Real a_extent = (aMax.x - aMin.x) / 2;
+			Real b_extent = (bMax.x - bMin.x) / 2;
 
-			double x_overlap = a_extent + b_extent - std::abs(n.x);
+			Real x_overlap = a_extent + b_extent - std::abs(n.x);
 
-			a_extent = (a->max.y - a->min.y) / 2;
-			b_extent = (b->max.y - b->min.y) / 2;
+			a_extent = (aMax.y - aMin.y) / 2;
+			b_extent = (bMax.y - bMin.y) / 2;
 
-			double y_overlap = a_extent + b_extent - std::abs(n.y);
+			Real y_overlap = a_extent + b_extent - std::abs(n.y);
 
 			if (x_overlap < y_overlap)
 			{
@@ -103,9 +279,14 @@ namespace SP2C
 
 				m->penetration = x_overlap;
 
-				m->contact_count = 2;
-				m->contact_points[0] = Vec2((n.x < 0 ? a->min.x : a->max.x), std::max(a->min.y, b->min.y));
-				m->contact_points[1] = Vec2(m->contact_points[0].x, std::min(a->max.y, b->max.y));
+				if (level == QueryContacts)
+				{
+					m->contact_count = 2;
+					m->contact_points[0] = Vec2((n.x < 0 ? aMin.x : aMax.x), std::max(aMin.y, bMin.y));
+					m->contact_points[1] = Vec2(m->contact_points[0].x, std::min(aMax.y, bMax.y));
+					m->ids[0] = MakeID(n.x < 0 ? 3 : 1, 0, false, SPC_ContactID::Face);
+					m->ids[1] = MakeID(n.x < 0 ? 3 : 1, 1, false, SPC_ContactID::Face);
+				}
 			}
 			else
 			{
@@ -116,9 +297,14 @@ namespace SP2C
 
 				m->penetration = y_overlap;
 
-				m->contact_count = 2;
-				m->contact_points[0] = Vec2(std::max(a->min.x, b->min.x), (n.y < 0 ? a->min.y : a->max.y));
-				m->contact_points[1] = Vec2(std::min(a->max.x, b->max.x), m->contact_points[0].y);
+				if (level == QueryContacts)
+				{
+					m->contact_count = 2;
+					m->contact_points[0] = Vec2(std::max(aMin.x, bMin.x), (n.y < 0 ? aMin.y : aMax.y));
+					m->contact_points[1] = Vec2(std::min(aMax.x, bMax.x), m->contact_points[0].y);
+					m->ids[0] = MakeID(n.y < 0 ? 0 : 2, 0, false, SPC_ContactID::Face);
+					m->ids[1] = MakeID(n.y < 0 ? 0 : 2, 1, false, SPC_ContactID::Face);
+				}
 			}
 
 			return true;
@@ -126,33 +312,24 @@ namespace SP2C
 
 		bool AABB_to_Circle(SPC_AABB& a, SPC_Circle& b)
 		{
-			Vec2 n = b.position - (a.min + a.max) / 2;
-
-			Vec2 closest = n; //get closest point from A to B
-			double x_extent = (a.max.x - a.min.x) / 2, y_extent = (a.max.y - a.min.y) / 2;
-			closest.x = Clamp(closest.x, -x_extent, x_extent);
-			closest.y = Clamp(closest.y, -y_extent, y_extent);
-
-			if (n == closest) //circle is inside AABB
-				return true;
-
-			Vec2 normal = n - closest;
-			double d = normal.LengthSquared();
-			double r = b.radius;
-
-			if (d > r * r) return false;
-			return true;
+			SPC_Manifold m;
+			return AABB_to_Circle(a.min, a.max, b.position, b.radius, &m, QueryOverlap);
 		}
 
 		bool AABB_to_Circle(SPC_Manifold* m)
 		{
-			SPC_AABB* a = reinterpret_cast<SPC_AABB*>(m->A);
-			SPC_Circle* b = reinterpret_cast<SPC_Circle*>(m->B);
+			return CollidePair<SPC_AABB, SPC_Circle>(m);
+		}
+
+		bool AABB_to_Circle(Vec2 aMin, Vec2 aMax, Vec2 position, Real radius, SPC_Manifold* m, SPC_QueryLevel level)
+		{
+			m->contact_count = 0;
 
-			Vec2 n = b->position - a->GetCenter();
+			Vec2 center = (aMin + aMax) / 2;
+			Vec2 n = position - center;
 
 			Vec2 closest = n; //get closest point from A to B
-			double x_extent = (a->max.x - a->min.x) / 2, y_extent = (a->max.y - a->min.y) / 2;
+			Real x_extent = (aMax.x - aMin.x) / 2, y_extent = (aMax.y - aMin.y) / 2;
 			closest.x = Clamp(closest.x, -x_extent, x_extent);
 			closest.y = Clamp(closest.y, -y_extent, y_extent);
 
@@ -169,158 +346,240 @@ namespace SP2C
 			}
 
 			Vec2 normal = n - closest;
-			double d = normal.LengthSquared();
-			double r = b->radius;
+			Real d = normal.LengthSquared();
+			Real r = radius;
 
 			if (d > r * r && !inside) return false;
 
+			if (level == QueryOverlap)
+				return true;
+
 			d = std::sqrt(d);
 			normal.Normalize();
 
-			m->contact_count = 1;
 			m->normal = inside ? -normal : normal;
 			m->penetration = inside ? 2 * r : r - d;
-			m->contact_points[0] = a->GetCenter() + closest;
+
+			if (level != QueryContacts)
+				return true;
+
+			m->contact_count = 1;
+			m->contact_points[0] = center + closest;
+
+			//faces and corners in the order of AABB_normals and GetVertices
+			bool x_side = std::abs(closest.x) == x_extent, y_side = std::abs(closest.y) == y_extent;
+			if (x_side && y_side && !inside)
+				m->ids[0] = MakeID(closest.y < 0 ? (closest.x < 0 ? 0 : 1) : (closest.x > 0 ? 2 : 3), 0, false, SPC_ContactID::Corner);
+			else if (x_side && (!y_side || std::abs(n.x) > std::abs(n.y)))
+				m->ids[0] = MakeID(closest.x > 0 ? 1 : 3, 0, false, SPC_ContactID::Face);
+			else
+				m->ids[0] = MakeID(closest.y > 0 ? 2 : 0, 0, false, SPC_ContactID::Face);
 
 			return true;
 		}
 
 		bool Circle_to_AABB(SPC_Manifold* m)
 		{
-			std::swap(m->A, m->B);
-			bool ret = AABB_to_Circle(m);
-			std::swap(m->A, m->B);
-			m->normal = -m->normal;
-
-			return ret;
+			return CollidePair<SPC_Circle, SPC_AABB>(m);
 		}
 
 		bool AABB_to_Polygon(SPC_AABB& a, SPC_Polygon& b)
 		{
-			Vec2 a_vertice[4];
-			a.GetVertices(a_vertice);
+			SPC_Manifold m;
+			return Collide(a, b, &m, nullptr, QueryOverlap);
+		}
+
+		bool AABB_to_Polygon(SPC_Manifold* m)
+		{
+			return AABB_to_Polygon(m, nullptr);
+		}
 
-			unsigned int faceA;
-			double penetrationA = FindAxisLeastPenetration(&faceA, a_vertice, (Vec2*)AABB_normals, 4, b.vertices, b.vertexCount);
-			if (penetrationA >= 0)
-				return false;
+		bool AABB_to_Polygon(SPC_Manifold* m, SPC_SATCache* cache)
+		{
+			return Collide(*static_cast<SPC_AABB*>(m->A), *static_cast<SPC_Polygon*>(m->B), m, cache);
+		}
 
-			unsigned int faceB;
-			double penetrationB = FindAxisLeastPenetration(&faceB, b.vertices, b.normals, b.vertexCount, a_vertice, 4);
-			if (penetrationB >= 0)
+		bool Polygon_to_AABB(SPC_Manifold* m)
+		{
+			return Polygon_to_AABB(m, nullptr);
+		}
+
+		bool Polygon_to_AABB(SPC_Manifold* m, SPC_SATCache* cache)
+		{
+			return Collide(*static_cast<SPC_Polygon*>(m->A), *static_cast<SPC_AABB*>(m->B), m, cache);
+		}
+
+		bool Circle_to_Circle(SPC_Circle& a, SPC_Circle& b)
+		{
+			SPC_Manifold m;
+			return Circle_to_Circle(a.position, a.radius, b.position, b.radius, &m, QueryOverlap);
+		}
+
+		bool Circle_to_Circle(SPC_Manifold* m)
+		{
+			return CollidePair<SPC_Circle, SPC_Circle>(m);
+		}
+
+		bool Circle_to_Circle(Vec2 aPosition, Real aRadius, Vec2 bPosition, Real bRadius, SPC_Manifold* m, SPC_QueryLevel level)
+		{
+			Vec2 n = bPosition - aPosition;
+			Real r = aRadius + bRadius;
+			Real d = n.LengthSquared();
+			m->contact_count = 0;
+
+			if (d > r * r)
 				return false;
 
-			unsigned int referenceIndex, refSize, incSize;
+			if (level == QueryOverlap)
+				return true;
 
-			Vec2* refVertices, * refNormals;
-			Vec2* incVertices, * incNormals;
+			d = std::sqrt(d);
 
-			if (penetrationA >= penetrationB)
+			if (d != 0)
 			{
-				refVertices = a_vertice;
-				refNormals = (Vec2*)AABB_normals;
-				incVertices = b.vertices;
-				incNormals = b.normals;
-
-				refSize = 4;
-				incSize = b.vertexCount;
-				referenceIndex = faceA;
+				m->penetration = r - d;
+				m->normal = n / d;
 			}
 			else
 			{
-				refVertices = b.vertices;
-				refNormals = b.normals;
-				incVertices = a_vertice;
-				incNormals = (Vec2*)AABB_normals;
-
-				refSize = b.vertexCount;
-				incSize = 4;
-				referenceIndex = faceB;
+				m->penetration = aRadius;
+				m->normal = { 1,0 };
 			}
 
-			Vec2 incidentFace[2];
-			FindIncidentFace(incidentFace, refNormals[referenceIndex], incVertices, incNormals, incSize);
+			if (level == QueryContacts)
+			{
+				m->contact_count = 1;
+				m->contact_points[0] = d != 0 ? m->normal * aRadius + aPosition : aPosition;
+				m->ids[0] = MakeID(0, 0, false, SPC_ContactID::Vertex);
+			}
 
-			Vec2 v1 = refVertices[referenceIndex];
-			referenceIndex = referenceIndex + 1 < refSize ? referenceIndex + 1 : 0;
-			Vec2 v2 = refVertices[referenceIndex];
+			return true;
+		}
 
-			Vec2 sidePlaneNormal = v2 - v1;
-			sidePlaneNormal.Normalize();
+		bool Circle_to_Polygon(SPC_Circle& a, SPC_Polygon& b)
+		{
+			SPC_Manifold m;
+			return Circle_to_Polygon(a.position, a.radius, b.vertices, b.normals, b.vertexCount, &m, QueryOverlap);
+		}
 
-			Vec2 refFaceNormal(sidePlaneNormal.y, -sidePlaneNormal.x);
+		bool Circle_to_Polygon(SPC_Manifold* m)
+		{
+			return CollidePair<SPC_Circle, SPC_Polygon>(m);
+		}
 
-			double refC = DotProduct(refFaceNormal, v1);
-			double negSide = -DotProduct(sidePlaneNormal, v1);
-			double posSide = DotProduct(sidePlaneNormal, v2);
+		bool Circle_to_Polygon(Vec2 position, Real radius, Vec2* vertices, Vec2* normals, unsigned int count, SPC_Manifold* m, SPC_QueryLevel level)
+		{
+			m->contact_count = 0;
 
-			if (Clip(-sidePlaneNormal, negSide, incidentFace) < 2)
-				return false;
+			Vec2 center = position;
 
-			if (Clip(sidePlaneNormal, posSide, incidentFace) < 2)
-				return false;
+			Real separation = -REAL_MAX;
+			unsigned int faceNormal = 0;
 
-			for (int i = 0; i < 2; i++)
+			for (unsigned int i = 0; i < count; i++)
 			{
-				double separation = DotProduct(refFaceNormal, incidentFace[i]) - refC;
-				if (separation <= 0) return true;
+				Real s = DotProduct(normals[i], center - vertices[i]);
+
+				if (s > radius) return false;
+
+				if (s > separation)
+				{
+					separation = s;
+					faceNormal = i;
+				}
 			}
 
-			return false;
-		}
+			Vec2 v1 = vertices[faceNormal];
+			unsigned int i2 = faceNormal + 1 < count ? faceNormal + 1 : 0;
+			Vec2 v2 = vertices[i2];
 
-		bool AABB_to_Polygon(SPC_Manifold* m)
-		{
-			SPC_AABB* a = reinterpret_cast<SPC_AABB*>(m->A);
-			SPC_Polygon* b = reinterpret_cast<SPC_Polygon*>(m->B);
+			//the center is inside: the closest face. otherwise the corner or the face of the voronoi region of the center
+			unsigned int feature = faceNormal;
+			SPC_ContactID::FeatureType type = SPC_ContactID::Face;
 
-			Vec2 a_vertice[4];
-			a->GetVertices(a_vertice);
+			if (separation >= 1e-4)
+			{
+				Real dot1 = DotProduct(center - v1, v2 - v1);
+				Real dot2 = DotProduct(center - v2, v1 - v2);
 
-			unsigned int faceA;
-			double penetrationA = FindAxisLeastPenetration(&faceA, a_vertice, (Vec2*)AABB_normals, 4, b->vertices, b->vertexCount);
-			if (penetrationA >= 0)
-				return false;
+				if (dot1 <= 0)
+				{
+					if (DistanceSquared(center, v1) > radius * radius)
+						return false;
 
-			unsigned int faceB;
-			double penetrationB = FindAxisLeastPenetration(&faceB, b->vertices, b->normals, b->vertexCount, a_vertice, 4);
-			if (penetrationB >= 0)
-				return false;
+					type = SPC_ContactID::Corner;
+				}
+				else if (dot2 <= 0)
+				{
+					if (DistanceSquared(center, v2) > radius * radius)
+						return false;
 
-			unsigned int referenceIndex, refSize, incSize;
+					feature = i2;
+					type = SPC_ContactID::Corner;
+				}
+				else if (DotProduct(center - v1, normals[faceNormal]) > radius)
+					return false;
+			}
 
-			Vec2* refVertices, * refNormals;
-			Vec2* incVertices, * incNormals;
+			if (level == QueryOverlap)
+				return true;
 
-			bool flip;
+			m->penetration = separation < 1e-4 ? radius : radius - separation;
 
-			if (penetrationA >= penetrationB)
+			if (type == SPC_ContactID::Corner)
 			{
-				refVertices = a_vertice;
-				refNormals = (Vec2*)AABB_normals;
-				incVertices = b->vertices;
-				incNormals = b->normals;
+				Vec2 n = vertices[feature] - center;
+				n.Normalize();
 
-				refSize = 4;
-				incSize = b->vertexCount;
-				referenceIndex = faceA;
-				flip = false;
+				m->normal = n;
 			}
 			else
-			{
-				refVertices = b->vertices;
-				refNormals = b->normals;
-				incVertices = a_vertice;
-				incNormals = (Vec2*)AABB_normals;
+				m->normal = -normals[faceNormal];
 
-				refSize = b->vertexCount;
-				incSize = 4;
-				referenceIndex = faceB;
-				flip = true;
+			if (level == QueryContacts)
+			{
+				m->contact_count = 1;
+				m->contact_points[0] = type == SPC_ContactID::Corner ? vertices[feature] : m->normal * radius + position;
+				m->ids[0] = MakeID(feature, 0, true, type);
 			}
 
+			return true;
+		}
+
+		bool Polygon_to_Circle(SPC_Manifold* m)
+		{
+			return CollidePair<SPC_Polygon, SPC_Circle>(m);
+		}
+
+		bool Polygon_to_Polygon(SPC_Polygon& a, SPC_Polygon& b)
+		{
+			SPC_Manifold m;
+			return Polygon_to_Polygon(a.vertices, a.normals, a.vertexCount, b.vertices, b.normals, b.vertexCount, &m, nullptr, QueryOverlap);
+		}
+
+		bool Polygon_to_Polygon(SPC_Manifold* m)
+		{
+			return Polygon_to_Polygon(m, nullptr);
+		}
+
+		bool Polygon_to_Polygon(SPC_Manifold* m, SPC_SATCache* cache)
+		{
+			return Collide(*static_cast<SPC_Polygon*>(m->A), *static_cast<SPC_Polygon*>(m->B), m, cache);
+		}
+
+		//contacts of the incident face of inc clipped by the reference face of ref. flip when ref is B
+		static bool ClipReferenceFace(Vec2* refVertices, Vec2* refNormals, unsigned int refSize, unsigned int referenceIndex,
+			Vec2* incVertices, Vec2* incNormals, unsigned int incSize, bool flip, SPC_Manifold* m)
+		{
 			Vec2 incidentFace[2];
-			FindIncidentFace(incidentFace, refNormals[referenceIndex], incVertices, incNormals, incSize);
+			unsigned int incidentIndex = FindIncidentFace(incidentFace, refNormals[referenceIndex], incVertices, incNormals, incSize);
+
+			SPC_ContactID ids[2];
+			ids[0] = MakeID(referenceIndex, incidentIndex, flip, SPC_ContactID::Vertex);
+			ids[1] = MakeID(referenceIndex, incidentIndex + 1 < incSize ? incidentIndex + 1 : 0, flip, SPC_ContactID::Vertex);
+
+			SPC_ContactID negID = MakeID(referenceIndex, incidentIndex, flip, SPC_ContactID::ClippedNeg);
+			SPC_ContactID posID = MakeID(referenceIndex, incidentIndex, flip, SPC_ContactID::ClippedPos);
 
 			Vec2 v1 = refVertices[referenceIndex];
 			referenceIndex = referenceIndex + 1 < refSize ? referenceIndex + 1 : 0;
@@ -331,24 +590,25 @@ namespace SP2C
 
 			Vec2 refFaceNormal(sidePlaneNormal.y, -sidePlaneNormal.x);
 
-			double refC = DotProduct(refFaceNormal, v1);
-			double negSide = -DotProduct(sidePlaneNormal, v1);
-			double posSide = DotProduct(sidePlaneNormal, v2);
+			Real refC = DotProduct(refFaceNormal, v1);
+			Real negSide = -DotProduct(sidePlaneNormal, v1);
+			Real posSide = DotProduct(sidePlaneNormal, v2);
 
-			if (Clip(-sidePlaneNormal, negSide, incidentFace) < 2)
-				return false;
+			m->normal = flip ? -refFaceNormal : refFaceNormal;
 
-			if (Clip(sidePlaneNormal, posSide, incidentFace) < 2)
+			if (Clip(-sidePlaneNormal, negSide, incidentFace, ids, negID) < 2)
 				return false;
 
-			m->normal = flip ? -refFaceNormal : refFaceNormal;
+			if (Clip(sidePlaneNormal, posSide, incidentFace, ids, posID) < 2)
+				return false;
 
 			unsigned int cp = 0;
-			double separation = DotProduct(refFaceNormal, incidentFace[0]) - refC;
+			Real separation = DotProduct(refFaceNormal, incidentFace[0]) - refC;
 
 			if (separation <= 0)
 			{
 				m->contact_points[cp] = incidentFace[0];
+				m->ids[cp] = ids[0];
 				m->penetration = -separation;
 				cp++;
 			}
@@ -359,6 +619,7 @@ namespace SP2C
 			if (separation <= 0)
 			{
 				m->contact_points[cp] = incidentFace[1];
+				m->ids[cp] = ids[1];
 				m->penetration += -separation;
 				cp++;
 
@@ -369,334 +630,1234 @@ namespace SP2C
 			return m->contact_count > 0;
 		}
 
-		bool Polygon_to_AABB(SPC_Manifold* m)
-		{
-			std::swap(m->A, m->B);
-			bool ret = AABB_to_Polygon(m);
-			std::swap(m->A, m->B);
-			m->normal = -m->normal;
-
-			return ret;
-		}
-
-		bool Circle_to_Circle(SPC_Circle& a, SPC_Circle& b)
-		{
-			double r = a.radius + b.radius;
-			Vec2 n = b.position - a.position;
-			double d = n.LengthSquared();
-
-			if (r * r < d) return false;
-			return true;
-		}
-
-		bool Circle_to_Circle(SPC_Manifold* m)
+		bool Polygon_to_Polygon(Vec2* aVertices, Vec2* aNormals, unsigned int aCount, Vec2* bVertices, Vec2* bNormals, unsigned int bCount, SPC_Manifold* m, SPC_SATCache* cache, SPC_QueryLevel level)
 		{
-			SPC_Circle* a = reinterpret_cast<SPC_Circle*>(m->A);
-			SPC_Circle* b = reinterpret_cast<SPC_Circle*>(m->B);
-
-			Vec2 n = b->position - a->position;
-			double r = a->radius + b->radius;
-			double d = n.LengthSquared();
 			m->contact_count = 0;
 
-			if (d > r * r)
+			if (TestCachedAxis(cache, aVertices, aNormals, aCount, bVertices, bNormals, bCount, &m->normal))
 				return false;
 
-			d = std::sqrt(d);
-			m->contact_count = 1;
-
-			if (d != 0)
+			unsigned int faceA;
+			Real penetrationA = FindAxisLeastPenetration(&faceA, aVertices, aNormals, aCount, bVertices, bNormals, bCount);
+			if (penetrationA >= 0)
 			{
-				m->penetration = r - d;
-				m->normal = n / d;
-				m->contact_points[0] = m->normal * a->radius + a->position;
+				SetCachedAxis(cache, faceA, 0);
+				m->normal = aNormals[faceA];
+				return false;
 			}
-			else
-			{
-				m->penetration = a->radius;
-				m->normal = { 1,0 };
-				m->contact_points[0] = a->position;
+
+			unsigned int faceB;
+			Real penetrationB = FindAxisLeastPenetration(&faceB, bVertices, bNormals, bCount, aVertices, aNormals, aCount);
+			if (penetrationB >= 0)
+			{
+				SetCachedAxis(cache, faceB, 1);
+				m->normal = -bNormals[faceB];
+				return false;
 			}
 
-			return true;
+			//the axis of least penetration is the first candidate next time, and the reference face of ComputeContacts
+			if (penetrationA >= penetrationB)
+				SetCachedAxis(cache, faceA, 0);
+			else
+				SetCachedAxis(cache, faceB, 1);
+
+			if (level == QueryOverlap)
+				return true;
+
+			if (level == QueryPenetration)
+			{
+				m->normal = penetrationA >= penetrationB ? aNormals[faceA] : -bNormals[faceB];
+				m->penetration = -std::max(penetrationA, penetrationB);
+				return true;
+			}
+
+			if (penetrationA >= penetrationB)
+				return ClipReferenceFace(aVertices, aNormals, aCount, faceA, bVertices, bNormals, bCount, false, m);
+			else
+				return ClipReferenceFace(bVertices, bNormals, bCount, faceB, aVertices, aNormals, aCount, true, m);
 		}
 
-		bool Circle_to_Polygon(SPC_Circle& a, SPC_Polygon& b)
+		bool ComputeContacts(Vec2* aVertices, Vec2* aNormals, unsigned int aCount, Vec2* bVertices, Vec2* bNormals, unsigned int bCount, SPC_Manifold* m, const SPC_SATCache& cache)
 		{
-			Vec2 center = a.position;
+			assert(cache.valid);
+			m->contact_count = 0;
 
-			double separation = -DBL_MAX;
-			unsigned int faceNormal = 0;
+			if (cache.shape == 0)
+				return cache.face < aCount && ClipReferenceFace(aVertices, aNormals, aCount, cache.face, bVertices, bNormals, bCount, false, m);
+			else
+				return cache.face < bCount && ClipReferenceFace(bVertices, bNormals, bCount, cache.face, aVertices, aNormals, aCount, true, m);
+		}
 
-			for (unsigned int i = 0; i < b.vertexCount; i++)
+		bool Collide(SPC_Manifold* m)
+		{
+			return CollideFunc[m->A->type][m->B->type](m);
+		}
+
+		bool Collide(SPC_Manifold* m, SPC_SATCache* cache)
+		{
+			return QueryFunc[m->A->type][m->B->type](m, cache, QueryContacts);
+		}
+
+		bool Collide(SPC_Manifold* m, SPC_SATCache* cache, SPC_QueryLevel level)
+		{
+			return QueryFunc[m->A->type][m->B->type](m, cache, level);
+		}
+
+		//vertices and normals of the SAT kernels. an aabb writes its corners to the buffer
+		static void GetFaces(SPC_Shape* shape, Vec2* corners, Vec2** vertices, Vec2** normals, unsigned int* count)
+		{
+			if (shape->type == SPC_Shape::AABB)
+			{
+				static_cast<SPC_AABB*>(shape)->GetVertices(corners);
+				*vertices = corners;
+				*normals = (Vec2*)AABB_normals;
+				*count = 4;
+			}
+			else
 			{
-				double s = DotProduct(b.normals[i], center - b.vertices[i]);
+				SPC_Polygon* polygon = static_cast<SPC_Polygon*>(shape);
+				*vertices = polygon->vertices;
+				*normals = polygon->normals;
+				*count = polygon->vertexCount;
+			}
+		}
 
-				if (s > a.radius) return false;
+		bool ComputeContacts(SPC_Manifold* m, SPC_SATCache* cache)
+		{
+			SPC_Shape::ShapeType a = m->A->type, b = m->B->type;
+			bool sat = a != SPC_Shape::Circle && b != SPC_Shape::Circle && (a == SPC_Shape::Polygon || b == SPC_Shape::Polygon);
 
-				if (s > separation)
+			if (!sat || !cache || !cache->valid)
+				return Collide(m, cache, QueryContacts);
+
+			//a polygon and an aabb were tested with the aabb first, and the cache refers to that order
+			bool swap = a == SPC_Shape::Polygon && b == SPC_Shape::AABB;
+
+			Vec2 aCorners[4], bCorners[4];
+			Vec2* aVertices, * aNormals, * bVertices, * bNormals;
+			unsigned int aCount, bCount;
+
+			GetFaces(swap ? m->B : m->A, aCorners, &aVertices, &aNormals, &aCount);
+			GetFaces(swap ? m->A : m->B, bCorners, &bVertices, &bNormals, &bCount);
+
+			bool ret = ComputeContacts(aVertices, aNormals, aCount, bVertices, bNormals, bCount, m, *cache);
+			if (swap)
+				FlipManifold(m);
+
+			return ret;
+		}
+
+		bool Collide(SPC_Shape* a, SPC_Shape* b)
+		{
+			if (a->type >= SPC_Shape::Count || b->type >= SPC_Shape::Count) //unknown shape
+				return false;
+
+			SPC_Manifold m;
+			m.A = a;
+			m.B = b;
+
+			return QueryFunc[a->type][b->type](&m, nullptr, QueryOverlap);
+		}
+
+		static inline bool IsTurned(const SPC_Transform2D& t)
+		{
+			return t.sin != 0 || t.cos != 1;
+		}
+
+		//contact points and normal from the space of t to the world
+		static void ToWorld(const SPC_Transform2D& t, SPC_Manifold* m)
+		{
+			m->normal = t.ApplyRotation(m->normal);
+			for (unsigned int i = 0; i < m->contact_count; i++)
+				m->contact_points[i] = t.Apply(m->contact_points[i]);
+		}
+
+		//the polygon with fewer vertices is moved into the space of the other one, on the stack.
+		//hulls over STACK_POLY go to a buffer of the thread, which only grows, so it allocates once for the biggest hull
+		static bool Polygon_to_Polygon(Vec2* aVertices, Vec2* aNormals, unsigned int aCount, const SPC_Transform2D& ta,
+			Vec2* bVertices, Vec2* bNormals, unsigned int bCount, const SPC_Transform2D& tb, SPC_Manifold* m, SPC_SATCache* cache)
+		{
+			bool moveB = bCount <= aCount;
+			SPC_Transform2D t = moveB ? Relative(ta, tb) : Relative(tb, ta);
+			Vec2* vertices = moveB ? bVertices : aVertices;
+			Vec2* normals = moveB ? bNormals : aNormals;
+			unsigned int count = moveB ? bCount : aCount;
+
+			Vec2 buffer[2 * SPC_Polygon::STACK_POLY];
+			Vec2* localVertices = buffer, * localNormals = buffer + SPC_Polygon::STACK_POLY;
+			if (count > SPC_Polygon::STACK_POLY)
+			{
+				static thread_local std::vector<Vec2> scratch;
+				if (scratch.size() < 2 * count)
+					scratch.resize(2 * count);
+
+				localVertices = scratch.data();
+				localNormals = scratch.data() + count;
+			}
+
+			for (unsigned int i = 0; i < count; i++)
+			{
+				localVertices[i] = t.Apply(vertices[i]);
+				localNormals[i] = t.ApplyRotation(normals[i]);
+			}
+
+			bool ret;
+			if (moveB)
+				ret = Polygon_to_Polygon(aVertices, aNormals, aCount, localVertices, localNormals, count, m, cache);
+			else
+				ret = Polygon_to_Polygon(localVertices, localNormals, count, bVertices, bNormals, bCount, m, cache);
+
+			ToWorld(moveB ? ta : tb, m);
+			return ret;
+		}
+
+		bool Circle_to_Circle(SPC_Circle& a, const SPC_Transform2D& ta, SPC_Circle& b, const SPC_Transform2D& tb, SPC_Manifold* m)
+		{
+			return Circle_to_Circle(ta.Apply(a.position), a.radius, tb.Apply(b.position), b.radius, m);
+		}
+
+		bool Circle_to_Polygon(SPC_Circle& a, const SPC_Transform2D& ta, SPC_Polygon& b, const SPC_Transform2D& tb, SPC_Manifold* m)
+		{
+			bool ret = Circle_to_Polygon(tb.ApplyInverse(ta.Apply(a.position)), a.radius, b.vertices, b.normals, b.vertexCount, m);
+			ToWorld(tb, m);
+			return ret;
+		}
+
+		bool Polygon_to_Circle(SPC_Polygon& a, const SPC_Transform2D& ta, SPC_Circle& b, const SPC_Transform2D& tb, SPC_Manifold* m)
+		{
+			bool ret = Circle_to_Polygon(b, tb, a, ta, m);
+			FlipManifold(m);
+
+			return ret;
+		}
+
+		bool Polygon_to_Polygon(SPC_Polygon& a, const SPC_Transform2D& ta, SPC_Polygon& b, const SPC_Transform2D& tb, SPC_Manifold* m, SPC_SATCache* cache)
+		{
+			return Polygon_to_Polygon(a.vertices, a.normals, a.vertexCount, ta, b.vertices, b.normals, b.vertexCount, tb, m, cache);
+		}
+
+		bool Collide(SPC_Shape* a, const SPC_Transform2D& ta, SPC_Shape* b, const SPC_Transform2D& tb, SPC_Manifold* m, SPC_SATCache* cache)
+		{
+			//aabbs which don't turn keep their own tests. the others are boxes
+			if (a->type == SPC_Shape::AABB && !IsTurned(ta))
+			{
+				SPC_AABB* box = static_cast<SPC_AABB*>(a);
+				Vec2 min = box->min + ta.position, max = box->max + ta.position;
+
+				if (b->type == SPC_Shape::AABB && !IsTurned(tb))
 				{
-					separation = s;
-					faceNormal = i;
+					SPC_AABB* other = static_cast<SPC_AABB*>(b);
+					return AABB_to_AABB(min, max, other->min + tb.position, other->max + tb.position, m);
+				}
+				else if (b->type == SPC_Shape::Circle)
+				{
+					SPC_Circle* circle = static_cast<SPC_Circle*>(b);
+					return AABB_to_Circle(min, max, tb.Apply(circle->position), circle->radius, m);
 				}
 			}
+			else if (a->type == SPC_Shape::Circle && b->type == SPC_Shape::AABB && !IsTurned(tb))
+			{
+				SPC_Circle* circle = static_cast<SPC_Circle*>(a);
+				SPC_AABB* box = static_cast<SPC_AABB*>(b);
 
-			Vec2 v1 = b.vertices[faceNormal];
-			unsigned int i2 = faceNormal + 1 < b.vertexCount ? faceNormal + 1 : 0;
-			Vec2 v2 = b.vertices[i2];
+				bool ret = AABB_to_Circle(box->min + tb.position, box->max + tb.position, ta.Apply(circle->position), circle->radius, m);
+				FlipManifold(m);
 
-			if (separation < 1e-4)
-				return true;
+				return ret;
+			}
 
-			double dot1 = DotProduct(center - v1, v2 - v1);
-			double dot2 = DotProduct(center - v2, v1 - v2);
+			Vec2 aCorners[4], bCorners[4];
+			Vec2* aVertices, * aNormals, * bVertices, * bNormals;
+			unsigned int aCount, bCount;
 
-			if (dot1 <= 0)
+			if (a->type == SPC_Shape::Circle)
 			{
-				if (DistanceSquared(center, v1) > a.radius * a.radius)
-					return false;
+				SPC_Circle* circle = static_cast<SPC_Circle*>(a);
+				if (b->type == SPC_Shape::Circle)
+					return Circle_to_Circle(*circle, ta, *static_cast<SPC_Circle*>(b), tb, m);
+
+				GetFaces(b, bCorners, &bVertices, &bNormals, &bCount);
+
+				bool ret = Circle_to_Polygon(tb.ApplyInverse(ta.Apply(circle->position)), circle->radius, bVertices, bNormals, bCount, m);
+				ToWorld(tb, m);
+				return ret;
 			}
-			else if (dot2 <= 0)
+
+			GetFaces(a, aCorners, &aVertices, &aNormals, &aCount);
+
+			if (b->type == SPC_Shape::Circle)
 			{
-				if (DistanceSquared(center, v2) > a.radius * a.radius)
-					return false;
+				SPC_Circle* circle = static_cast<SPC_Circle*>(b);
+
+				bool ret = Circle_to_Polygon(ta.ApplyInverse(tb.Apply(circle->position)), circle->radius, aVertices, aNormals, aCount, m);
+				ToWorld(ta, m);
+				FlipManifold(m);
+
+				return ret;
+			}
+
+			GetFaces(b, bCorners, &bVertices, &bNormals, &bCount);
+			return Polygon_to_Polygon(aVertices, aNormals, aCount, ta, bVertices, bNormals, bCount, tb, m, cache);
+		}
+
+		bool Collide(SPC_Shape* a, Vec2 offsetA, SPC_Shape* b, Vec2 offsetB, SPC_Manifold* m, SPC_SATCache* cache)
+		{
+			return Collide(SPC_ShapeView(a, offsetA), SPC_ShapeView(b, offsetB), m, cache);
+		}
+
+		bool Collide(const SPC_ShapeView& a, const SPC_ShapeView& b, SPC_Manifold* m, SPC_SATCache* cache)
+		{
+			return Collide(a.shape, a.transform, b.shape, b.transform, m, cache);
+		}
+
+		//clip [enter, exit] by the slab of one axis. entered is set when the slab moves enter
+		static inline bool ClipSlab(Real o, Real d, Real lo, Real hi, Real* enter, Real* exit, bool* entered)
+		{
+			*entered = false;
+
+			if (d == 0) //parallel to the slab
+				return lo <= o && o <= hi;
+
+			Real t1 = (lo - o) / d, t2 = (hi - o) / d;
+			if (t1 > t2) std::swap(t1, t2);
+
+			if (t1 > *enter)
+			{
+				*enter = t1;
+				*entered = true;
 			}
+
+			if (t2 < *exit)
+				*exit = t2;
+
+			return *enter <= *exit;
+		}
+
+		bool Raycast(const SPC_AABB& a, Vec2 origin, Vec2 dir, Real maxT, SPC_RaycastHit* hit)
+		{
+			Real enter = -REAL_MAX, exit = REAL_MAX;
+			bool entered, xAxis = false;
+
+			if (!ClipSlab(origin.x, dir.x, a.min.x, a.max.x, &enter, &exit, &entered))
+				return false;
+			xAxis = entered;
+
+			if (!ClipSlab(origin.y, dir.y, a.min.y, a.max.y, &enter, &exit, &entered))
+				return false;
+			if (entered) xAxis = false;
+
+			if (enter < 0 || enter > maxT) //starts inside, or too far
+				return false;
+
+			hit->t = enter;
+			hit->point = origin + enter * dir;
+
+			if (xAxis)
+				hit->face = dir.x > 0 ? 3 : 1;
 			else
+				hit->face = dir.y > 0 ? 0 : 2;
+
+			hit->normal = AABB_normals[hit->face];
+			return true;
+		}
+
+		bool Raycast(const SPC_Circle& a, Vec2 origin, Vec2 dir, Real maxT, SPC_RaycastHit* hit)
+		{
+			Vec2 m = origin - a.position;
+			Real c = m.LengthSquared() - a.radius * a.radius;
+			if (c < 0) //starts inside
+				return false;
+
+			Real b = DotProduct(m, dir);
+			Real dd = dir.LengthSquared();
+			Real disc = b * b - dd * c;
+
+			if (dd == 0 || disc < 0)
+				return false;
+
+			Real t = (-b - std::sqrt(disc)) / dd;
+			if (t < 0 || t > maxT)
+				return false;
+
+			hit->t = t;
+			hit->point = origin + t * dir;
+			hit->normal = (hit->point - a.position) / a.radius;
+			hit->face = -1;
+			return true;
+		}
+
+		bool Raycast(const SPC_Polygon& a, Vec2 origin, Vec2 dir, Real maxT, SPC_RaycastHit* hit)
+		{
+			//clip the ray by the half planes of the faces
+			Real lower = 0, upper = maxT;
+			int index = -1;
+
+			for (unsigned int i = 0; i < a.vertexCount; i++)
 			{
-				Vec2 n = b.normals[faceNormal];
-				if (DotProduct(center - v1, n) > a.radius)
+				Real numerator = DotProduct(a.normals[i], a.vertices[i] - origin);
+				Real denominator = DotProduct(a.normals[i], dir);
+
+				if (denominator == 0)
+				{
+					if (numerator < 0) //parallel and outside
+						return false;
+				}
+				else if (denominator < 0 && numerator < lower * denominator) //entering the half plane
+				{
+					lower = numerator / denominator;
+					index = i;
+				}
+				else if (denominator > 0 && numerator < upper * denominator) //leaving the half plane
+					upper = numerator / denominator;
+
+				if (upper < lower)
 					return false;
 			}
 
+			if (index < 0) //starts inside
+				return false;
+
+			hit->t = lower;
+			hit->point = origin + lower * dir;
+			hit->normal = a.normals[index];
+			hit->face = index;
 			return true;
 		}
 
-		bool Circle_to_Polygon(SPC_Manifold* m)
+		bool Raycast(SPC_Shape* shape, Vec2 origin, Vec2 dir, Real maxT, SPC_RaycastHit* hit)
 		{
-			SPC_Circle* a = reinterpret_cast<SPC_Circle*>(m->A);
-			SPC_Polygon* b = reinterpret_cast<SPC_Polygon*>(m->B);
+			switch (shape->type)
+			{
+			case SPC_Shape::ShapeType::AABB:
+				return Raycast(*reinterpret_cast<SPC_AABB*>(shape), origin, dir, maxT, hit);
 
-			m->contact_count = 0;
+			case SPC_Shape::ShapeType::Circle:
+				return Raycast(*reinterpret_cast<SPC_Circle*>(shape), origin, dir, maxT, hit);
 
-			Vec2 center = a->position;
+			case SPC_Shape::ShapeType::Polygon:
+				return Raycast(*reinterpret_cast<SPC_Polygon*>(shape), origin, dir, maxT, hit);
 
-			double separation = -DBL_MAX;
-			unsigned int faceNormal = 0;
+			default: //unknown shape
+				return false;
+			}
+		}
+
+		bool RayOverlap(Vec2 min, Vec2 max, Vec2 origin, Vec2 dir, Real maxT)
+		{
+			Real enter = 0, exit = maxT;
+			bool entered;
+
+			return ClipSlab(origin.x, dir.x, min.x, max.x, &enter, &exit, &entered) && ClipSlab(origin.y, dir.y, min.y, max.y, &enter, &exit, &entered);
+		}
+
+		Real RaycastShape(int proxyId, SPC_Shape* shape, Real maxT, void* data)
+		{
+			SPC_RaycastResult* result = reinterpret_cast<SPC_RaycastResult*>(data);
+
+			SPC_RaycastHit hit;
+			if (!Raycast(shape, result->origin, result->dir, maxT, &hit))
+				return maxT;
+
+			hit.shape = shape;
+			hit.proxyId = proxyId;
+
+			switch (result->mode)
+			{
+			case RaycastClosest:
+				if (result->capacity > 0) result->hits[0] = hit;
+				result->count = 1;
+				return hit.t; //only closer hits from now
+
+			case RaycastAny:
+				if (result->capacity > 0) result->hits[0] = hit;
+				result->count = 1;
+				return 0;
+
+			default:
+				if (result->count < result->capacity) result->hits[result->count] = hit;
+				result->count++;
+				return maxT;
+			}
+		}
 
-			for (unsigned int i = 0; i < b->vertexCount; i++)
+		//vertices of a shape for the distance queries. a circle is one vertex with a radius.
+		//a polygon proxy points to the arrays of the polygon, the others own their vertices in storage
+		struct SPC_DistanceProxy
+		{
+			Vec2* vertices;
+			Vec2* normals;
+			unsigned int count;
+			Real radius;
+			SPC_Polygon storage;
+		};
+
+		static void MakeProxy(SPC_Shape* shape, SPC_DistanceProxy* proxy)
+		{
+			proxy->radius = 0;
+			proxy->vertices = proxy->storage.vertices;
+			proxy->normals = proxy->storage.normals;
+
+			switch (shape->type)
 			{
-				double s = DotProduct(b->normals[i], center - b->vertices[i]);
+			case SPC_Shape::ShapeType::AABB:
+				reinterpret_cast<SPC_AABB*>(shape)->GetVertices(proxy->vertices);
+				std::copy(AABB_normals, AABB_normals + 4, proxy->normals);
+				proxy->count = 4;
+				break;
 
-				if (s > a->radius) return false;
+			case SPC_Shape::ShapeType::Circle:
+				proxy->vertices[0] = reinterpret_cast<SPC_Circle*>(shape)->position;
+				proxy->radius = reinterpret_cast<SPC_Circle*>(shape)->radius;
+				proxy->count = 1;
+				break;
 
-				if (s > separation)
+			default:
+			{
+				SPC_Polygon* polygon = reinterpret_cast<SPC_Polygon*>(shape);
+				proxy->vertices = polygon->vertices;
+				proxy->normals = polygon->normals;
+				proxy->count = polygon->vertexCount;
+				break;
+			}
+			}
+		}
+
+		static void MoveProxy(const SPC_DistanceProxy& base, const SPC_Sweep& sweep, Real t, SPC_DistanceProxy* proxy)
+		{
+			Real rad = sweep.rotation * t * Const::RAD;
+			Real sin = std::sin(rad), cos = std::cos(rad);
+			Vec2 offset = sweep.center + sweep.translation * t;
+
+			proxy->storage.Reserve(base.count);
+			proxy->vertices = proxy->storage.vertices;
+			proxy->normals = proxy->storage.normals;
+
+			for (unsigned int i = 0; i < base.count; i++)
+			{
+				Vec2 d = base.vertices[i] - sweep.center;
+				proxy->vertices[i] = offset + Vec2(cos * d.x - sin * d.y, sin * d.x + cos * d.y);
+
+				Vec2 n = base.normals[i];
+				proxy->normals[i] = Vec2(cos * n.x - sin * n.y, sin * n.x + cos * n.y);
+			}
+
+			proxy->count = base.count;
+			proxy->radius = base.radius;
+		}
+
+		//separation of a and b on axis (from a to b)
+		static inline Real AxisSeparation(const SPC_DistanceProxy& a, const SPC_DistanceProxy& b, Vec2 axis)
+		{
+			Vec2* av = a.vertices;
+			Vec2* bv = b.vertices;
+			return DotProduct(axis, GetSupport(-axis, bv, b.count)) - DotProduct(axis, GetSupport(axis, av, a.count));
+		}
+
+		//vertex of the proxy closest to p
+		static inline Vec2 ClosestVertex(const SPC_DistanceProxy& a, Vec2 p)
+		{
+			Vec2 best = a.vertices[0];
+			for (unsigned int i = 1; i < a.count; i++)
+				if (DistanceSquared(a.vertices[i], p) < DistanceSquared(best, p))
+					best = a.vertices[i];
+
+			return best;
+		}
+
+		static inline Vec2 Centroid(const SPC_DistanceProxy& a)
+		{
+			Vec2 sum = VEC_ZERO;
+			for (unsigned int i = 0; i < a.count; i++)
+				sum += a.vertices[i];
+
+			return sum / a.count;
+		}
+
+		static Real ProxySeparation(const SPC_DistanceProxy& a, const SPC_DistanceProxy& b, Vec2* normal)
+		{
+			Real best = -REAL_MAX;
+			Vec2* av = a.vertices;
+			Vec2* bv = b.vertices;
+
+			//faces. the projection on any axis is a lower bound of the distance
+			if (a.count > 1)
+				for (unsigned int i = 0; i < a.count; i++)
 				{
-					separation = s;
-					faceNormal = i;
+					Real d = DotProduct(a.normals[i], GetSupport(-a.normals[i], bv, b.count) - a.vertices[i]);
+					if (d > best)
+					{
+						best = d;
+						*normal = a.normals[i];
+					}
+				}
+
+			if (b.count > 1)
+				for (unsigned int i = 0; i < b.count; i++)
+				{
+					Real d = DotProduct(b.normals[i], GetSupport(-b.normals[i], av, a.count) - b.vertices[i]);
+					if (d > best)
+					{
+						best = d;
+						*normal = -b.normals[i];
+					}
+				}
+
+			//vertex regions. exact for circles, and keeps the bound tight when corners face each other
+			Vec2 centerA = Centroid(a), centerB = Centroid(b);
+			Vec2 candidates[2];
+			candidates[0] = centerB - ClosestVertex(a, centerB);
+			candidates[1] = ClosestVertex(b, centerA) - centerA;
+
+			for (int k = 0; k < 2; k++)
+			{
+				Vec2 axis = candidates[k];
+				Real length = axis.Length();
+				if (length == 0) continue;
+
+				axis = axis / length;
+				Real d = AxisSeparation(a, b, axis);
+				if (d > best)
+				{
+					best = d;
+					*normal = axis;
 				}
 			}
 
-			Vec2 v1 = b->vertices[faceNormal];
-			unsigned int i2 = faceNormal + 1 < b->vertexCount ? faceNormal + 1 : 0;
-			Vec2 v2 = b->vertices[i2];
+			return best - a.radius - b.radius;
+		}
+
+		Real SeparationBound(SPC_Shape* a, SPC_Shape* b, Vec2* normal)
+		{
+			SPC_DistanceProxy pa, pb;
+			MakeProxy(a, &pa);
+			MakeProxy(b, &pb);
+
+			return ProxySeparation(pa, pb, normal);
+		}
 
-			if (separation < 1e-4)
+		//vertex of the proxy furthest along d. the lowest index wins ties, like GetSupport
+		static inline unsigned int SupportIndex(const SPC_DistanceProxy& proxy, Vec2 d)
+		{
+			unsigned int best = 0;
+			Real bestProjection = DotProduct(proxy.vertices[0], d);
+
+			for (unsigned int i = 1; i < proxy.count; i++)
 			{
-				m->contact_count = 1;
-				m->normal = -b->normals[faceNormal];
-				m->contact_points[0] = m->normal * a->radius + a->position;
-				m->penetration = a->radius;
-				return true;
+				Real projection = DotProduct(proxy.vertices[i], d);
+				if (projection > bestProjection)
+				{
+					best = i;
+					bestProjection = projection;
+				}
 			}
 
-			double dot1 = DotProduct(center - v1, v2 - v1);
-			double dot2 = DotProduct(center - v2, v1 - v2);
-			m->penetration = a->radius - separation;
+			return best;
+		}
 
-			if (dot1 <= 0)
+		struct SPC_SimplexVertex
+		{
+			Vec2 wA; //support point of A
+			Vec2 wB; //support point of B
+			Vec2 w; //wB - wA
+			Real a; //barycentric coordinate of the closest point
+			unsigned int indexA;
+			unsigned int indexB;
+		};
+
+		//simplex of the minkowski difference B - A
+		struct SPC_Simplex
+		{
+			SPC_SimplexVertex v[3];
+			unsigned int count;
+
+			void Read(const SPC_SimplexCache* cache, const SPC_DistanceProxy& a, const SPC_DistanceProxy& b)
 			{
-				if (DistanceSquared(center, v1) > a->radius * a->radius)
-					return false;
+				count = cache ? cache->count : 0;
 
-				m->contact_count = 1;
-				Vec2 n = v1 - center;
-				n.Normalize();
+				for (unsigned int i = 0; i < count; i++)
+				{
+					SPC_SimplexVertex& vertex = v[i];
+					vertex.indexA = cache->indexA[i];
+					vertex.indexB = cache->indexB[i];
+
+					if (vertex.indexA >= a.count || vertex.indexB >= b.count) //the shapes changed
+					{
+						count = 0;
+						break;
+					}
+
+					vertex.wA = a.vertices[vertex.indexA];
+					vertex.wB = b.vertices[vertex.indexB];
+					vertex.w = vertex.wB - vertex.wA;
+					vertex.a = 0;
+				}
 
-				m->normal = n;
-				m->contact_points[0] = v1;
+				//start over when the simplex changed too much since the cache was written
+				if (count > 1)
+				{
+					Real metric1 = cache->metric, metric2 = GetMetric();
+					if (metric2 < 0.5 * metric1 || 2 * metric1 < metric2 || metric2 < REAL_EPSILON)
+						count = 0;
+				}
+
+				if (count == 0)
+				{
+					SPC_SimplexVertex& vertex = v[0];
+					vertex.indexA = 0;
+					vertex.indexB = 0;
+					vertex.wA = a.vertices[0];
+					vertex.wB = b.vertices[0];
+					vertex.w = vertex.wB - vertex.wA;
+					vertex.a = 1;
+					count = 1;
+				}
 			}
-			else if (dot2 <= 0)
+
+			void Write(SPC_SimplexCache* cache) const
 			{
-				if (DistanceSquared(center, v2) > a->radius * a->radius)
-					return false;
+				cache->metric = GetMetric();
+				cache->count = count;
 
-				m->contact_count = 1;
-				Vec2 n = v2 - center;
-				n.Normalize();
+				for (unsigned int i = 0; i < count; i++)
+				{
+					cache->indexA[i] = (unsigned short)v[i].indexA;
+					cache->indexB[i] = (unsigned short)v[i].indexB;
+				}
+			}
 
-				m->normal = n;
-				m->contact_points[0] = v2;
+			//length or area, to tell if a cached simplex is still usable
+			Real GetMetric() const
+			{
+				switch (count)
+				{
+				case 2: return (v[0].w - v[1].w).Length();
+				case 3: return CrossProduct(v[1].w - v[0].w, v[2].w - v[0].w);
+				default: return 0;
+				}
+			}
+
+			Vec2 GetSearchDirection() const
+			{
+				if (count == 1)
+					return -v[0].w;
+
+				Vec2 e12 = v[1].w - v[0].w;
+				if (CrossProduct(e12, -v[0].w) > 0) //origin is left of e12
+					return CrossProduct(1.0, e12);
+
+				return CrossProduct(e12, 1.0);
+			}
+
+			void GetWitnessPoints(Vec2* pA, Vec2* pB) const
+			{
+				switch (count)
+				{
+				case 1:
+					*pA = v[0].wA;
+					*pB = v[0].wB;
+					break;
+
+				case 2:
+					*pA = v[0].a * v[0].wA + v[1].a * v[1].wA;
+					*pB = v[0].a * v[0].wB + v[1].a * v[1].wB;
+					break;
+
+				default: //the origin is inside, so the shapes overlap
+					*pA = v[0].a * v[0].wA + v[1].a * v[1].wA + v[2].a * v[2].wA;
+					*pB = *pA;
+					break;
+				}
+			}
+
+			//closest point of the segment to the origin, by the barycentric coordinates
+			void Solve2()
+			{
+				Vec2 w1 = v[0].w, w2 = v[1].w;
+				Vec2 e12 = w2 - w1;
+
+				Real d12_2 = -DotProduct(w1, e12);
+				if (d12_2 <= 0) //region of w1
+				{
+					v[0].a = 1;
+					count = 1;
+					return;
+				}
+
+				Real d12_1 = DotProduct(w2, e12);
+				if (d12_1 <= 0) //region of w2
+				{
+					v[1].a = 1;
+					count = 1;
+					v[0] = v[1];
+					return;
+				}
+
+				Real inv = 1 / (d12_1 + d12_2);
+				v[0].a = d12_1 * inv;
+				v[1].a = d12_2 * inv;
+				count = 2;
+			}
+
+			//closest point of the triangle to the origin, checking the vertex, edge and face regions
+			void Solve3()
+			{
+				Vec2 w1 = v[0].w, w2 = v[1].w, w3 = v[2].w;
+
+				Vec2 e12 = w2 - w1;
+				Real d12_1 = DotProduct(w2, e12);
+				Real d12_2 = -DotProduct(w1, e12);
+
+				Vec2 e13 = w3 - w1;
+				Real d13_1 = DotProduct(w3, e13);
+				Real d13_2 = -DotProduct(w1, e13);
+
+				Vec2 e23 = w3 - w2;
+				Real d23_1 = DotProduct(w3, e23);
+				Real d23_2 = -DotProduct(w2, e23);
+
+				Real n123 = CrossProduct(e12, e13);
+				Real d123_1 = n123 * CrossProduct(w2, w3);
+				Real d123_2 = n123 * CrossProduct(w3, w1);
+				Real d123_3 = n123 * CrossProduct(w1, w2);
+
+				if (d12_2 <= 0 && d13_2 <= 0) //w1
+				{
+					v[0].a = 1;
+					count = 1;
+				}
+				else if (d12_1 > 0 && d12_2 > 0 && d123_3 <= 0) //e12
+				{
+					Real inv = 1 / (d12_1 + d12_2);
+					v[0].a = d12_1 * inv;
+					v[1].a = d12_2 * inv;
+					count = 2;
+				}
+				else if (d13_1 > 0 && d13_2 > 0 && d123_2 <= 0) //e13
+				{
+					Real inv = 1 / (d13_1 + d13_2);
+					v[0].a = d13_1 * inv;
+					v[2].a = d13_2 * inv;
+					count = 2;
+					v[1] = v[2];
+				}
+				else if (d12_1 <= 0 && d23_2 <= 0) //w2
+				{
+					v[1].a = 1;
+					count = 1;
+					v[0] = v[1];
+				}
+				else if (d13_1 <= 0 && d23_1 <= 0) //w3
+				{
+					v[2].a = 1;
+					count = 1;
+					v[0] = v[2];
+				}
+				else if (d23_1 > 0 && d23_2 > 0 && d123_1 <= 0) //e23
+				{
+					Real inv = 1 / (d23_1 + d23_2);
+					v[1].a = d23_1 * inv;
+					v[2].a = d23_2 * inv;
+					count = 2;
+					v[0] = v[2];
+				}
+				else //inside the triangle
+				{
+					Real inv = 1 / (d123_1 + d123_2 + d123_3);
+					v[0].a = d123_1 * inv;
+					v[1].a = d123_2 * inv;
+					v[2].a = d123_3 * inv;
+					count = 3;
+				}
+			}
+		};
+
+		static Real ProxyDistance(const SPC_DistanceProxy& a, const SPC_DistanceProxy& b, SPC_DistanceResult* result, SPC_SimplexCache* cache)
+		{
+			SPC_Simplex simplex;
+			simplex.Read(cache, a, b);
+
+			unsigned int savedA[3], savedB[3];
+			int iterations = 0;
+
+			while (iterations < MAX_GJK_ITERATIONS)
+			{
+				//vertices of the last simplex, to catch a repeated support point
+				unsigned int savedCount = simplex.count;
+				for (unsigned int i = 0; i < savedCount; i++)
+				{
+					savedA[i] = simplex.v[i].indexA;
+					savedB[i] = simplex.v[i].indexB;
+				}
+
+				if (simplex.count == 2)
+					simplex.Solve2();
+				else if (simplex.count == 3)
+					simplex.Solve3();
+
+				if (simplex.count == 3) //the origin is inside
+					break;
+
+				Vec2 d = simplex.GetSearchDirection();
+				if (d.LengthSquared() < REAL_EPSILON * REAL_EPSILON) //the origin is on the simplex
+					break;
+
+				SPC_SimplexVertex& vertex = simplex.v[simplex.count];
+				vertex.indexA = SupportIndex(a, -d);
+				vertex.wA = a.vertices[vertex.indexA];
+				vertex.indexB = SupportIndex(b, d);
+				vertex.wB = b.vertices[vertex.indexB];
+				vertex.w = vertex.wB - vertex.wA;
+
+				iterations++;
+
+				//no progress. the closest point is found
+				bool duplicate = false;
+				for (unsigned int i = 0; i < savedCount; i++)
+					if (vertex.indexA == savedA[i] && vertex.indexB == savedB[i])
+					{
+						duplicate = true;
+						break;
+					}
+
+				if (duplicate)
+					break;
+
+				simplex.count++;
+			}
+
+			Vec2 pA, pB;
+			simplex.GetWitnessPoints(&pA, &pB);
+
+			if (cache)
+				simplex.Write(cache);
+
+			Real distance = (pB - pA).Length();
+			Real radius = a.radius + b.radius;
+			result->iterations = iterations;
+
+			if (distance > radius && distance > REAL_EPSILON)
+			{
+				//move the points to the surfaces of the circles
+				Vec2 normal = (pB - pA) / distance;
+				result->pointA = pA + a.radius * normal;
+				result->pointB = pB - b.radius * normal;
+				result->normal = normal;
+				result->distance = distance - radius;
 			}
 			else
 			{
-				Vec2 n = b->normals[faceNormal];
-				if (DotProduct(center - v1, n) > a->radius)
+				Vec2 p = (pA + pB) / 2;
+				result->pointA = p;
+				result->pointB = p;
+				result->normal = VEC_ZERO;
+				result->distance = 0;
+			}
+
+			return result->distance;
+		}
+
+		Real Distance(SPC_Shape* a, SPC_Shape* b, SPC_DistanceResult* result, SPC_SimplexCache* cache)
+		{
+			SPC_DistanceProxy pa, pb;
+			MakeProxy(a, &pa);
+			MakeProxy(b, &pb);
+
+			return ProxyDistance(pa, pb, result, cache);
+		}
+
+		//farthest distance from the center of the sweep to a vertex. the radius doesn't count,
+		//a circle turning around its own position doesn't move
+		static Real SweepRadius(const SPC_DistanceProxy& proxy, Vec2 center)
+		{
+			Real r = 0;
+			for (unsigned int i = 0; i < proxy.count; i++)
+				r = std::max(r, DistanceSquared(proxy.vertices[i], center));
+
+			return std::sqrt(r);
+		}
+
+		bool TimeOfImpact(SPC_Shape* a, const SPC_Sweep& sweepA, SPC_Shape* b, const SPC_Sweep& sweepB, SPC_TOIResult* result, Real tolerance)
+		{
+			SPC_DistanceProxy baseA, baseB, pa, pb;
+			MakeProxy(a, &baseA);
+			MakeProxy(b, &baseB);
+
+			//no point of B gets closer to A than this per unit of t
+			Real speed = (sweepB.translation - sweepA.translation).Length()
+				+ std::abs(sweepA.rotation * Const::RAD) * SweepRadius(baseA, sweepA.center)
+				+ std::abs(sweepB.rotation * Const::RAD) * SweepRadius(baseB, sweepB.center);
+
+			Real t = 0;
+			result->iterations = 0;
+
+			//the simplex of the last step is a good start for the next one
+			SPC_SimplexCache cache;
+			cache.count = 0;
+
+			while (true)
+			{
+				if (result->iterations == MAX_TOI_ITERATIONS)
+				{
+					result->state = SPC_TOIResult::Failed;
+					result->t = t;
 					return false;
+				}
 
-				m->normal = -n;
-				m->contact_points[0] = m->normal * a->radius + a->position;
-				m->contact_count = 1;
+				MoveProxy(baseA, sweepA, t, &pa);
+				MoveProxy(baseB, sweepB, t, &pb);
+
+				SPC_DistanceResult distance;
+				Real d = ProxyDistance(pa, pb, &distance, &cache);
+				result->iterations++;
+
+				if (d < tolerance)
+				{
+					result->state = d <= 0 && t == 0 ? SPC_TOIResult::Overlapped : SPC_TOIResult::Touching;
+					result->t = t;
+					result->normal = distance.normal;
+					return true;
+				}
+
+				if (speed == 0)
+					break;
+
+				//the separation can't drop to tolerance / 2 before this
+				t += (d - tolerance / 2) / speed;
+				if (t >= 1)
+					break;
 			}
 
-			return true;
+			result->state = SPC_TOIResult::Separated;
+			result->t = 1;
+			return false;
 		}
 
-		bool Polygon_to_Circle(SPC_Manifold* m)
+		struct SPC_PairBuffer
 		{
-			std::swap(m->A, m->B);
-			bool ret = Circle_to_Polygon(m);
-			std::swap(m->A, m->B);
-			m->normal = -m->normal;
+			SPC_Manifold* out;
+			int capacity;
+			int count;
+		};
 
-			return ret;
+		static void AddPair(SPC_Manifold* pair, void* data)
+		{
+			SPC_PairBuffer* buffer = reinterpret_cast<SPC_PairBuffer*>(data);
+			if (buffer->count < buffer->capacity)
+				buffer->out[buffer->count] = *pair;
+
+			buffer->count++;
 		}
 
-		bool Polygon_to_Polygon(SPC_Polygon& a, SPC_Polygon& b)
+		static void AddCollision(SPC_Manifold* pair, void* data)
 		{
-			unsigned int faceA;
-			double penetrationA = FindAxisLeastPenetration(&faceA, a.vertices, a.normals, a.vertexCount, b.vertices, b.vertexCount);
-			if (penetrationA >= 0)
-				return false;
+			SPC_PairBuffer* buffer = reinterpret_cast<SPC_PairBuffer*>(data);
+			if (!Collide(pair))
+				return;
 
-			unsigned int faceB;
-			double penetrationB = FindAxisLeastPenetration(&faceB, b.vertices, b.normals, b.vertexCount, a.vertices, a.vertexCount);
-			if (penetrationB >= 0)
-				return false;
+			if (buffer->count < buffer->capacity)
+				buffer->out[buffer->count] = *pair;
 
-			return true;
+			buffer->count++;
 		}
 
-		bool Polygon_to_Polygon(SPC_Manifold* m)
+		static SPC_SweepAndPrune& GetBroadphase()
 		{
-			SPC_Polygon* a = reinterpret_cast<SPC_Polygon*>(m->A);
-			SPC_Polygon* b = reinterpret_cast<SPC_Polygon*>(m->B);
+			static thread_local SPC_SweepAndPrune broadphase(SPC_SweepAndPrune::AxisAuto);
+			return broadphase;
+		}
 
-			unsigned int faceA;
-			double penetrationA = FindAxisLeastPenetration(&faceA, a->vertices, a->normals, a->vertexCount, b->vertices, b->vertexCount);
-			if (penetrationA >= 0)
-				return false;
+		int FindPairs(SPC_Shape** shapes, int count, SPC_Manifold* out_pairs, int capacity)
+		{
+			SPC_SweepAndPrune& broadphase = GetBroadphase();
+			broadphase.Set(shapes, count);
 
-			unsigned int faceB;
-			double penetrationB = FindAxisLeastPenetration(&faceB, b->vertices, b->normals, b->vertexCount, a->vertices, a->vertexCount);
-			if (penetrationB >= 0)
-				return false;
+			SPC_PairBuffer buffer = { out_pairs, capacity, 0 };
+			broadphase.QueryPairs(AddPair, &buffer);
+			return buffer.count;
+		}
 
-			unsigned int referenceIndex;
+		int FindPairs(SPC_Shape** shapes, int count, SPC_Manifold* out_pairs, int capacity, SPC_ThreadPool& pool)
+		{
+			SPC_SweepAndPrune& broadphase = GetBroadphase();
+			broadphase.Set(shapes, count, pool);
 
-			SPC_Polygon* ref, * inc;
-			bool flip;
+			SPC_PairBuffer buffer = { out_pairs, capacity, 0 };
+			broadphase.QueryPairs(AddPair, &buffer, pool);
+			return buffer.count;
+		}
 
-			if (penetrationA >= penetrationB)
+		int CollideAll(SPC_Manifold* pairs, int count)
+		{
+			int hits = 0;
+			for (int i = 0; i < count; i++)
 			{
-				ref = a;
-				inc = b;
-				referenceIndex = faceA;
-				flip = false;
+				if (!Collide(&pairs[i]))
+					continue;
+
+				if (hits != i)
+					pairs[hits] = pairs[i];
+
+				hits++;
 			}
-			else
+
+			return hits;
+		}
+
+		int CollideAll(SPC_Shape** shapes, int count, SPC_Manifold* out, int capacity)
+		{
+			SPC_SweepAndPrune& broadphase = GetBroadphase();
+			broadphase.Set(shapes, count);
+
+			SPC_PairBuffer buffer = { out, capacity, 0 };
+			broadphase.QueryPairs(AddCollision, &buffer);
+			return buffer.count;
+		}
+
+		double EstimateCost(SPC_Manifold* m)
+		{
+			unsigned int n = 1, k = 1;
+
+			if (m->A->type == SPC_Shape::Polygon) n = reinterpret_cast<SPC_Polygon*>(m->A)->vertexCount;
+			if (m->B->type == SPC_Shape::Polygon) k = reinterpret_cast<SPC_Polygon*>(m->B)->vertexCount;
+
+			switch (m->A->type * SPC_Shape::Count + m->B->type)
 			{
-				ref = b;
-				inc = a;
-				referenceIndex = faceB;
-				flip = true;
-			}
+			case SPC_Shape::AABB * SPC_Shape::Count + SPC_Shape::AABB:
+			case SPC_Shape::Circle * SPC_Shape::Count + SPC_Shape::Circle:
+				return 1;
 
-			Vec2 incidentFace[2];
-			FindIncidentFace(incidentFace, ref->normals[referenceIndex], inc->vertices, inc->normals, inc->vertexCount);
+			case SPC_Shape::AABB * SPC_Shape::Count + SPC_Shape::Circle:
+			case SPC_Shape::Circle * SPC_Shape::Count + SPC_Shape::AABB:
+				return 2;
 
-			Vec2 v1 = ref->vertices[referenceIndex];
-			referenceIndex = referenceIndex + 1 == ref->vertexCount ? 0 : referenceIndex + 1;
-			Vec2 v2 = ref->vertices[referenceIndex];
+			case SPC_Shape::Circle * SPC_Shape::Count + SPC_Shape::Polygon:
+			case SPC_Shape::Polygon * SPC_Shape::Count + SPC_Shape::Circle:
+				return 2 + n * k; //one of them is 1
 
-			Vec2 sidePlaneNormal = v2 - v1;
-			sidePlaneNormal.Normalize();
+			case SPC_Shape::AABB * SPC_Shape::Count + SPC_Shape::Polygon:
+			case SPC_Shape::Polygon * SPC_Shape::Count + SPC_Shape::AABB:
+				return 4 + 9 * (n * k); //two 4 * n scans and the incident face
 
-			Vec2 refFaceNormal(sidePlaneNormal.y, -sidePlaneNormal.x);
+			default: //two n * k scans and the incident face
+				return 4 + 2.0 * n * k + n + k;
+			}
+		}
 
-			double refC = DotProduct(refFaceNormal, v1);
-			double negSide = -DotProduct(sidePlaneNormal, v1);
-			double posSide = DotProduct(sidePlaneNormal, v2);
+		static const int MAX_CHUNKS = 256;
+		static const int MIN_CHUNK_SIZE = 32;
 
-			if (Clip(-sidePlaneNormal, negSide, incidentFace) < 2)
-				return false;
+		struct SPC_CollideJob
+		{
+			SPC_Manifold* pairs;
+			int chunkCount;
+			int begin[MAX_CHUNKS + 1]; //chunk boundaries
+			int hits[MAX_CHUNKS];
+			double costs[MAX_CHUNKS];
+		};
+
+		static void CollideChunk(int task, int /*worker*/, void* data)
+		{
+			SPC_CollideJob* job = reinterpret_cast<SPC_CollideJob*>(data);
 
-			if (Clip(sidePlaneNormal, posSide, incidentFace) < 2)
-				return false;
+			int begin = job->begin[task], end = job->begin[task + 1];
+			job->hits[task] = CollideAll(job->pairs + begin, end - begin);
+		}
 
-			m->normal = flip ? -refFaceNormal : refFaceNormal;
+		int CollideAll(SPC_Manifold* pairs, int count, SPC_ThreadPool& pool)
+		{
+			int workers = pool.GetWorkerCount();
+			if (workers == 1 || count < 2 * MIN_CHUNK_SIZE)
+				return CollideAll(pairs, count);
 
-			unsigned int cp = 0;
-			double separation = DotProduct(refFaceNormal, incidentFace[0]) - refC;
+			SPC_CollideJob job;
+			job.pairs = pairs;
 
-			if (separation <= 0)
+			//several chunks per worker of about the same estimated cost, so the scheduler has something to steal
+			job.chunkCount = std::min(std::min(MAX_CHUNKS, workers * 8), count / MIN_CHUNK_SIZE);
+
+			double total = 0;
+			for (int i = 0; i < count; i++)
+				total += EstimateCost(&pairs[i]);
+
+			int chunk = 0;
+			double sum = 0, chunkCost = 0;
+			job.begin[0] = 0;
+
+			for (int i = 0; i < count; i++)
 			{
-				m->contact_points[cp] = incidentFace[0];
-				m->penetration = -separation;
-				cp++;
+				double cost = EstimateCost(&pairs[i]);
+				sum += cost;
+				chunkCost += cost;
+
+				if (chunk + 1 < job.chunkCount && sum >= total * (chunk + 1) / job.chunkCount)
+				{
+					job.costs[chunk] = chunkCost;
+					job.begin[++chunk] = i + 1;
+					chunkCost = 0;
+				}
 			}
-			else
-				m->penetration = 0;
 
-			separation = DotProduct(refFaceNormal, incidentFace[1]) - refC;
-			if (separation <= 0)
+			job.costs[chunk] = chunkCost;
+			job.chunkCount = chunk + 1;
+			job.begin[job.chunkCount] = count;
+
+			pool.Run(job.chunkCount, CollideChunk, &job, job.costs);
+
+			//merge the chunks in order
+			int hits = job.hits[0];
+			for (int i = 1; i < job.chunkCount; i++)
 			{
-				m->contact_points[cp] = incidentFace[1];
-				m->penetration += -separation;
-				cp++;
+				int begin = job.begin[i];
+				if (hits != begin)
+					std::copy(pairs + begin, pairs + begin + job.hits[i], pairs + hits);
 
-				m->penetration /= cp;
+				hits += job.hits[i];
 			}
 
-			m->contact_count = cp;
-			return m->contact_count > 0;
+			return hits;
 		}
 
-		bool Collide(SPC_Manifold* m)
+		struct SPC_ParallelBuffer
 		{
-			return CollideFunc[m->A->type][m->B->type](m);
+			SPC_Manifold* out;
+			int capacity;
+			int written; //next free slot
+			int collided; //manifolds before this are collisions
+			int overflow; //collisions found after out was full of collisions
+			SPC_ThreadPool* pool;
+		};
+
+		static void FlushPairs(SPC_ParallelBuffer* buffer)
+		{
+			int hits = CollideAll(buffer->out + buffer->collided, buffer->written - buffer->collided, *buffer->pool);
+			buffer->collided += hits;
+			buffer->written = buffer->collided;
 		}
 
-		bool Collide(SPC_Shape* a, SPC_Shape* b)
+		static void AddParallelPair(SPC_Manifold* pair, void* data)
 		{
-			switch (a->type)
-			{
-			case SPC_Shape::ShapeType::AABB:
-				if (b->type == SPC_Shape::ShapeType::AABB)
-					return AABB_to_AABB(*reinterpret_cast<SPC_AABB*>(a), *reinterpret_cast<SPC_AABB*>(b));
-				else if (b->type == SPC_Shape::ShapeType::Circle)
-					return AABB_to_Circle(*reinterpret_cast<SPC_AABB*>(a), *reinterpret_cast<SPC_Circle*>(b));
-				else
-					return AABB_to_Polygon(*reinterpret_cast<SPC_AABB*>(a), *reinterpret_cast<SPC_Polygon*>(b));
+			SPC_ParallelBuffer* buffer = reinterpret_cast<SPC_ParallelBuffer*>(data);
 
-			case SPC_Shape::ShapeType::Circle:
-				if (b->type == SPC_Shape::ShapeType::AABB)
-					return AABB_to_Circle(*reinterpret_cast<SPC_AABB*>(b), *reinterpret_cast<SPC_Circle*>(a));
-				else if (b->type == SPC_Shape::ShapeType::Circle)
-					return Circle_to_Circle(*reinterpret_cast<SPC_Circle*>(a), *reinterpret_cast<SPC_Circle*>(b));
-				else
-					return Circle_to_Polygon(*reinterpret_cast<SPC_Circle*>(a), *reinterpret_cast<SPC_Polygon*>(b));
+			if (buffer->written == buffer->capacity)
+				FlushPairs(buffer);
 
-			case SPC_Shape::ShapeType::Polygon:
-				if (b->type == SPC_Shape::ShapeType::AABB)
-					return AABB_to_Polygon(*reinterpret_cast<SPC_AABB*>(b), *reinterpret_cast<SPC_Polygon*>(a));
-				else if (b->type == SPC_Shape::ShapeType::Circle)
-					return Circle_to_Polygon(*reinterpret_cast<SPC_Circle*>(b), *reinterpret_cast<SPC_Polygon*>(a));
-				else
-					return Polygon_to_Polygon(*reinterpret_cast<SPC_Polygon*>(a), *reinterpret_cast<SPC_Polygon*>(b));
-			}
+			if (buffer->written < buffer->capacity)
+				buffer->out[buffer->written++] = *pair;
+			else if (Collide(pair)) //full of collisions. just count
+				buffer->overflow++;
+		}
 
-			//unknown shape
-			return false;
+		int CollideAll(SPC_Shape** shapes, int count, SPC_Manifold* out, int capacity, SPC_ThreadPool& pool)
+		{
+			SPC_SweepAndPrune& broadphase = GetBroadphase();
+			broadphase.Set(shapes, count, pool);
+
+			SPC_ParallelBuffer buffer = { out, capacity, 0, 0, 0, &pool };
+			broadphase.QueryPairs(AddParallelPair, &buffer, pool);
+			FlushPairs(&buffer);
+
+			return buffer.collided + buffer.overflow;
 		}
 	}
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
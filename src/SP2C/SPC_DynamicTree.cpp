@@ -0,0 +1,606 @@
+#if !defined(SP2C_SINGLE_TU) || defined(__SPC_UNITY__)
+#include <SP2C/SPC_DynamicTree.h>
+#include <SP2C/SPC_Collision.h>
+
+namespace SP2C
+{
+	bool SPC_TreeNode::IsLeaf() const
+	{
+		return child1 == SPC_NULL_PROXY;
+	}
+
+	SPC_DynamicTree::SPC_DynamicTree(Real margin, Real displacementMultiplier) : margin(margin), displacementMultiplier(displacementMultiplier)
+	{
+		root = SPC_NULL_PROXY;
+		freeList = SPC_NULL_PROXY;
+		proxyCount = 0;
+	}
+
+	int SPC_DynamicTree::AllocateNode()
+	{
+		if (freeList == SPC_NULL_PROXY) //grow the pool and link new nodes into the free list
+		{
+			int oldCount = (int)nodes.size();
+			int newCount = oldCount ? oldCount * 2 : 16;
+			nodes.resize(newCount);
+
+			for (int i = oldCount; i < newCount; i++)
+			{
+				nodes[i].parent = i + 1 < newCount ? i + 1 : SPC_NULL_PROXY;
+				nodes[i].height = -1;
+			}
+
+			freeList = oldCount;
+		}
+
+		int nodeId = freeList;
+		SPC_TreeNode& node = nodes[nodeId];
+		freeList = node.parent;
+
+		node.parent = SPC_NULL_PROXY;
+		node.child1 = SPC_NULL_PROXY;
+		node.child2 = SPC_NULL_PROXY;
+		node.height = 0;
+		node.shape = nullptr;
+		return nodeId;
+	}
+
+	void SPC_DynamicTree::FreeNode(int nodeId)
+	{
+		assert(0 <= nodeId && nodeId < (int)nodes.size());
+		nodes[nodeId].parent = freeList;
+		nodes[nodeId].height = -1;
+		freeList = nodeId;
+	}
+
+	int SPC_DynamicTree::CreateProxy(SPC_Shape* shape)
+	{
+		return CreateProxy(ComputeAABB(shape), shape);
+	}
+
+	int SPC_DynamicTree::CreateProxy(const SPC_AABB& aabb, SPC_Shape* shape)
+	{
+		int proxyId = AllocateNode();
+
+		SPC_TreeNode& node = nodes[proxyId];
+		node.aabb.min = aabb.min - Vec2(margin, margin);
+		node.aabb.max = aabb.max + Vec2(margin, margin);
+		node.shape = shape;
+		node.height = 0;
+
+		InsertLeaf(proxyId);
+		proxyCount++;
+
+		return proxyId;
+	}
+
+	void SPC_DynamicTree::DestroyProxy(int proxyId)
+	{
+		assert(0 <= proxyId && proxyId < (int)nodes.size());
+		assert(nodes[proxyId].IsLeaf());
+
+		RemoveLeaf(proxyId);
+		FreeNode(proxyId);
+		proxyCount--;
+	}
+
+	bool SPC_DynamicTree::MoveProxy(int proxyId, const SPC_AABB& aabb, Vec2 displacement)
+	{
+		assert(0 <= proxyId && proxyId < (int)nodes.size());
+		assert(nodes[proxyId].IsLeaf());
+
+		SPC_AABB fatAABB(aabb.min - Vec2(margin, margin), aabb.max + Vec2(margin, margin));
+
+		Vec2 d = displacement * displacementMultiplier;
+
+		if (d.x < 0) fatAABB.min.x += d.x;
+		else fatAABB.max.x += d.x;
+
+		if (d.y < 0) fatAABB.min.y += d.y;
+		else fatAABB.max.y += d.y;
+
+		const SPC_AABB& treeAABB = nodes[proxyId].aabb;
+		if (treeAABB.Contains(aabb))
+		{
+			//the fat aabb still contains the shape. reinsert only if it has grown too large (e.g. the shape stopped)
+			Vec2 r(4 * margin, 4 * margin);
+			SPC_AABB hugeAABB(fatAABB.min - r, fatAABB.max + r);
+
+			if (hugeAABB.Contains(treeAABB))
+				return false;
+		}
+
+		RemoveLeaf(proxyId);
+		nodes[proxyId].aabb = fatAABB;
+		InsertLeaf(proxyId);
+
+		return true;
+	}
+
+	bool SPC_DynamicTree::UpdateProxy(int proxyId, Vec2 displacement)
+	{
+		assert(0 <= proxyId && proxyId < (int)nodes.size());
+		return MoveProxy(proxyId, ComputeAABB(nodes[proxyId].shape), displacement);
+	}
+
+	SPC_Shape* SPC_DynamicTree::GetShape(int proxyId) const
+	{
+		assert(0 <= proxyId && proxyId < (int)nodes.size());
+		return nodes[proxyId].shape;
+	}
+
+	const SPC_AABB& SPC_DynamicTree::GetFatAABB(int proxyId) const
+	{
+		assert(0 <= proxyId && proxyId < (int)nodes.size());
+		return nodes[proxyId].aabb;
+	}
+
+	void SPC_DynamicTree::InsertLeaf(int leaf)
+	{
+		if (root == SPC_NULL_PROXY)
+		{
+			root = leaf;
+			nodes[root].parent = SPC_NULL_PROXY;
+			return;
+		}
+
+		//find the best sibling by the surface area heuristic
+		SPC_AABB leafAABB = nodes[leaf].aabb;
+		int index = root;
+
+		while (!nodes[index].IsLeaf())
+		{
+			int child1 = nodes[index].child1;
+			int child2 = nodes[index].child2;
+
+			Real area = GetArea(nodes[index].aabb);
+			Real combinedArea = GetArea(CombineAABB(nodes[index].aabb, leafAABB));
+
+			//cost of creating a new parent for this node and the new leaf
+			Real cost = 2 * combinedArea;
+
+			//minimum cost of pushing the leaf further down the tree
+			Real inheritanceCost = 2 * (combinedArea - area);
+
+			Real cost1, cost2;
+
+			if (nodes[child1].IsLeaf())
+				cost1 = GetArea(CombineAABB(leafAABB, nodes[child1].aabb)) + inheritanceCost;
+			else
+				cost1 = GetArea(CombineAABB(leafAABB, nodes[child1].aabb)) - GetArea(nodes[child1].aabb) + inheritanceCost;
+
+			if (nodes[child2].IsLeaf())
+				cost2 = GetArea(CombineAABB(leafAABB, nodes[child2].aabb)) + inheritanceCost;
+			else
+				cost2 = GetArea(CombineAABB(leafAABB, nodes[child2].aabb)) - GetArea(nodes[child2].aabb) + inheritanceCost;
+
+			if (cost < cost1 && cost < cost2)
+				break;
+
+			index = cost1 < cost2 ? child1 : child2;
+		}
+
+		int sibling = index;
+
+		//create a new parent. nodes can be reallocated here, so don't keep references before this
+		int oldParent = nodes[sibling].parent;
+		int newParent = AllocateNode();
+
+		nodes[newParent].parent = oldParent;
+		nodes[newParent].shape = nullptr;
+		nodes[newParent].aabb = CombineAABB(leafAABB, nodes[sibling].aabb);
+		nodes[newParent].height = nodes[sibling].height + 1;
+
+		if (oldParent != SPC_NULL_PROXY)
+		{
+			if (nodes[oldParent].child1 == sibling)
+				nodes[oldParent].child1 = newParent;
+			else
+				nodes[oldParent].child2 = newParent;
+		}
+		else
+			root = newParent;
+
+		nodes[newParent].child1 = sibling;
+		nodes[newParent].child2 = leaf;
+		nodes[sibling].parent = newParent;
+		nodes[leaf].parent = newParent;
+
+		//walk back up the tree fixing heights and aabbs
+		index = nodes[leaf].parent;
+		while (index != SPC_NULL_PROXY)
+		{
+			index = Balance(index);
+
+			int child1 = nodes[index].child1;
+			int child2 = nodes[index].child2;
+
+			assert(child1 != SPC_NULL_PROXY);
+			assert(child2 != SPC_NULL_PROXY);
+
+			nodes[index].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+			nodes[index].aabb = CombineAABB(nodes[child1].aabb, nodes[child2].aabb);
+
+			index = nodes[index].parent;
+		}
+	}
+
+	void SPC_DynamicTree::RemoveLeaf(int leaf)
+	{
+		if (leaf == root)
+		{
+			root = SPC_NULL_PROXY;
+			return;
+		}
+
+		int parent = nodes[leaf].parent;
+		int grandParent = nodes[parent].parent;
+		int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+		if (grandParent != SPC_NULL_PROXY)
+		{
+			//destroy the parent and connect the sibling to the grand parent
+			if (nodes[grandParent].child1 == parent)
+				nodes[grandParent].child1 = sibling;
+			else
+				nodes[grandParent].child2 = sibling;
+
+			nodes[sibling].parent = grandParent;
+			FreeNode(parent);
+
+			int index = grandParent;
+			while (index != SPC_NULL_PROXY)
+			{
+				index = Balance(index);
+
+				int child1 = nodes[index].child1;
+				int child2 = nodes[index].child2;
+
+				nodes[index].aabb = CombineAABB(nodes[child1].aabb, nodes[child2].aabb);
+				nodes[index].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+
+				index = nodes[index].parent;
+			}
+		}
+		else
+		{
+			root = sibling;
+			nodes[sibling].parent = SPC_NULL_PROXY;
+			FreeNode(parent);
+		}
+	}
+
+	int SPC_DynamicTree::Balance(int iA)
+	{
+		assert(iA != SPC_NULL_PROXY);
+
+		SPC_TreeNode* A = &nodes[iA];
+		if (A->IsLeaf() || A->height < 2)
+			return iA;
+
+		int iB = A->child1;
+		int iC = A->child2;
+
+		SPC_TreeNode* B = &nodes[iB];
+		SPC_TreeNode* C = &nodes[iC];
+
+		int balance = C->height - B->height;
+
+		if (balance > 1) //rotate C up
+		{
+			int iF = C->child1;
+			int iG = C->child2;
+			SPC_TreeNode* F = &nodes[iF];
+			SPC_TreeNode* G = &nodes[iG];
+
+			//swap A and C
+			C->child1 = iA;
+			C->parent = A->parent;
+			A->parent = iC;
+
+			if (C->parent != SPC_NULL_PROXY)
+			{
+				if (nodes[C->parent].child1 == iA)
+					nodes[C->parent].child1 = iC;
+				else
+					nodes[C->parent].child2 = iC;
+			}
+			else
+				root = iC;
+
+			//rotate
+			if (F->height > G->height)
+			{
+				C->child2 = iF;
+				A->child2 = iG;
+				G->parent = iA;
+
+				A->aabb = CombineAABB(B->aabb, G->aabb);
+				C->aabb = CombineAABB(A->aabb, F->aabb);
+
+				A->height = 1 + std::max(B->height, G->height);
+				C->height = 1 + std::max(A->height, F->height);
+			}
+			else
+			{
+				C->child2 = iG;
+				A->child2 = iF;
+				F->parent = iA;
+
+				A->aabb = CombineAABB(B->aabb, F->aabb);
+				C->aabb = CombineAABB(A->aabb, G->aabb);
+
+				A->height = 1 + std::max(B->height, F->height);
+				C->height = 1 + std::max(A->height, G->height);
+			}
+
+			return iC;
+		}
+
+		if (balance < -1) //rotate B up
+		{
+			int iD = B->child1;
+			int iE = B->child2;
+			SPC_TreeNode* D = &nodes[iD];
+			SPC_TreeNode* E = &nodes[iE];
+
+			//swap A and B
+			B->child1 = iA;
+			B->parent = A->parent;
+			A->parent = iB;
+
+			if (B->parent != SPC_NULL_PROXY)
+			{
+				if (nodes[B->parent].child1 == iA)
+					nodes[B->parent].child1 = iB;
+				else
+					nodes[B->parent].child2 = iB;
+			}
+			else
+				root = iB;
+
+			//rotate
+			if (D->height > E->height)
+			{
+				B->child2 = iD;
+				A->child1 = iE;
+				E->parent = iA;
+
+				A->aabb = CombineAABB(C->aabb, E->aabb);
+				B->aabb = CombineAABB(A->aabb, D->aabb);
+
+				A->height = 1 + std::max(C->height, E->height);
+				B->height = 1 + std::max(A->height, D->height);
+			}
+			else
+			{
+				B->child2 = iE;
+				A->child1 = iD;
+				D->parent = iA;
+
+				A->aabb = CombineAABB(C->aabb, D->aabb);
+				B->aabb = CombineAABB(A->aabb, E->aabb);
+
+				A->height = 1 + std::max(C->height, D->height);
+				B->height = 1 + std::max(A->height, E->height);
+			}
+
+			return iB;
+		}
+
+		return iA;
+	}
+
+	void SPC_DynamicTree::Query(SPC_AABB aabb, SPC_QueryCallback callback, void* data)
+	{
+		if (root == SPC_NULL_PROXY) return;
+
+		int stack[STACK_SIZE];
+		int count = 0;
+		stack[count++] = root;
+
+		while (count > 0)
+		{
+			int nodeId = stack[--count];
+			SPC_TreeNode& node = nodes[nodeId];
+
+			if (!Collision::AABB_to_AABB(node.aabb, aabb))
+				continue;
+
+			if (node.IsLeaf())
+			{
+				if (!callback(nodeId, node.shape, data))
+					return;
+			}
+			else
+			{
+				assert(count + 2 <= STACK_SIZE);
+				stack[count++] = node.child1;
+				stack[count++] = node.child2;
+			}
+		}
+	}
+
+	void SPC_DynamicTree::Raycast(Vec2 origin, Vec2 dir, Real maxT, SPC_RayCallback callback, void* data) const
+	{
+		if (root == SPC_NULL_PROXY) return;
+
+		int stack[STACK_SIZE];
+		int count = 0;
+		stack[count++] = root;
+
+		while (count > 0)
+		{
+			int nodeId = stack[--count];
+			const SPC_TreeNode& node = nodes[nodeId];
+
+			//maxT shrinks with the hits, so the subtrees behind the closest hit are skipped
+			if (!Collision::RayOverlap(node.aabb.min, node.aabb.max, origin, dir, maxT))
+				continue;
+
+			if (node.IsLeaf())
+			{
+				Real t = callback(nodeId, node.shape, maxT, data);
+				if (t <= 0)
+					return;
+
+				maxT = std::min(maxT, t);
+			}
+			else
+			{
+				assert(count + 2 <= STACK_SIZE);
+				stack[count++] = node.child1;
+				stack[count++] = node.child2;
+			}
+		}
+	}
+
+	int SPC_DynamicTree::Raycast(Vec2 origin, Vec2 dir, Real maxT, SPC_RaycastMode mode, SPC_RaycastHit* hits, int capacity) const
+	{
+		SPC_RaycastResult result = { origin, dir, mode, hits, capacity, 0 };
+		Raycast(origin, dir, maxT, Collision::RaycastShape, &result);
+		return result.count;
+	}
+
+	void SPC_DynamicTree::QueryPairs(SPC_PairCallback callback, void* data)
+	{
+		if (root == SPC_NULL_PROXY) return;
+
+		SPC_Manifold pair;
+		int stack[STACK_SIZE];
+
+		for (int i = 0; i < (int)nodes.size(); i++)
+		{
+			if (nodes[i].height != 0) //only leaves
+				continue;
+
+			SPC_AABB& aabb = nodes[i].aabb;
+			int count = 0;
+			stack[count++] = root;
+
+			while (count > 0)
+			{
+				int nodeId = stack[--count];
+				SPC_TreeNode& node = nodes[nodeId];
+
+				if (!Collision::AABB_to_AABB(node.aabb, aabb))
+					continue;
+
+				if (node.IsLeaf())
+				{
+					if (nodeId <= i) //report each pair once, from the smaller proxy id
+						continue;
+
+					pair.A = nodes[i].shape;
+					pair.B = node.shape;
+					pair.contact_count = 0;
+					callback(&pair, data);
+				}
+				else
+				{
+					assert(count + 2 <= STACK_SIZE);
+					stack[count++] = node.child1;
+					stack[count++] = node.child2;
+				}
+			}
+		}
+	}
+
+	int SPC_DynamicTree::GetHeight() const
+	{
+		if (root == SPC_NULL_PROXY) return 0;
+		return nodes[root].height;
+	}
+
+	int SPC_DynamicTree::GetMaxBalance() const
+	{
+		int maxBalance = 0;
+		for (int i = 0; i < (int)nodes.size(); i++)
+		{
+			const SPC_TreeNode& node = nodes[i];
+			if (node.height <= 1)
+				continue;
+
+			int balance = std::abs(nodes[node.child2].height - nodes[node.child1].height);
+			maxBalance = std::max(maxBalance, balance);
+		}
+
+		return maxBalance;
+	}
+
+	Real SPC_DynamicTree::GetAreaRatio() const
+	{
+		if (root == SPC_NULL_PROXY) return 0;
+
+		Real rootArea = GetArea(nodes[root].aabb);
+		Real totalArea = 0;
+
+		for (int i = 0; i < (int)nodes.size(); i++)
+			if (nodes[i].height >= 0)
+				totalArea += GetArea(nodes[i].aabb);
+
+		return rootArea > 0 ? totalArea / rootArea : 0;
+	}
+
+	int SPC_DynamicTree::ComputeHeight(int nodeId) const
+	{
+		const SPC_TreeNode& node = nodes[nodeId];
+		if (node.IsLeaf()) return 0;
+
+		return 1 + std::max(ComputeHeight(node.child1), ComputeHeight(node.child2));
+	}
+
+	void SPC_DynamicTree::ValidateNode(int nodeId) const
+	{
+		if (nodeId == SPC_NULL_PROXY) return;
+
+		const SPC_TreeNode& node = nodes[nodeId];
+		if (nodeId == root)
+			assert(node.parent == SPC_NULL_PROXY);
+
+		if (node.IsLeaf())
+		{
+			assert(node.child2 == SPC_NULL_PROXY);
+			assert(node.height == 0);
+			return;
+		}
+
+		int child1 = node.child1;
+		int child2 = node.child2;
+
+		assert(nodes[child1].parent == nodeId);
+		assert(nodes[child2].parent == nodeId);
+		assert(node.height == 1 + std::max(nodes[child1].height, nodes[child2].height));
+		assert(node.aabb.Contains(nodes[child1].aabb));
+		assert(node.aabb.Contains(nodes[child2].aabb));
+
+		ValidateNode(child1);
+		ValidateNode(child2);
+	}
+
+	void SPC_DynamicTree::Validate() const
+	{
+		ValidateNode(root);
+
+		int freeCount = 0;
+		int freeIndex = freeList;
+		while (freeIndex != SPC_NULL_PROXY)
+		{
+			assert(nodes[freeIndex].height == -1);
+			freeIndex = nodes[freeIndex].parent;
+			freeCount++;
+		}
+
+		assert(root == SPC_NULL_PROXY || ComputeHeight(root) == GetHeight());
+		assert(proxyCount == 0 || (int)nodes.size() - freeCount == 2 * proxyCount - 1);
+	}
+
+	void SPC_DynamicTree::Clear()
+	{
+		nodes.clear();
+		root = SPC_NULL_PROXY;
+		freeList = SPC_NULL_PROXY;
+		proxyCount = 0;
+	}
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,314 @@
+#if !defined(SP2C_SINGLE_TU) || defined(__SPC_UNITY__)
+#include <SP2C/SPC_HashGrid.h>
+
+namespace SP2C
+{
+	static inline bool ItemOverlap(const SPC_GridItem& a, const SPC_GridItem& b)
+	{
+		//same test as Collision::AABB_to_AABB
+		if (a.max.x < b.min.x || a.min.x > b.max.x) return false;
+		if (a.max.y < b.min.y || a.min.y > b.max.y) return false;
+		return true;
+	}
+
+	SPC_HashGrid::SPC_HashGrid(Real cellSize, Real percentile) : cellSize(cellSize), percentile(percentile)
+	{
+		tableSize = 0;
+		currentSize = cellSize;
+		inverseSize = cellSize > 0 ? 1 / cellSize : 0;
+	}
+
+	Real SPC_HashGrid::TuneCellSize(SPC_Circle** circles, int count, Real percentile)
+	{
+		if (count <= 0) return 1;
+
+		Real rmin = circles[0]->radius, rmax = circles[0]->radius;
+		for (int i = 1; i < count; i++)
+		{
+			rmin = std::min(rmin, circles[i]->radius);
+			rmax = std::max(rmax, circles[i]->radius);
+		}
+
+		Real r = rmax;
+
+		if (rmax > rmin)
+		{
+			unsigned int histogram[HISTOGRAM_SIZE] = { 0 };
+			Real width = (rmax - rmin) / HISTOGRAM_SIZE;
+
+			for (int i = 0; i < count; i++)
+			{
+				int bin = (int)((circles[i]->radius - rmin) / width);
+				histogram[std::min(bin, HISTOGRAM_SIZE - 1)]++;
+			}
+
+			unsigned int target = (unsigned int)std::ceil(count * Clamp(percentile, 0, 1));
+			unsigned int sum = 0;
+
+			for (int i = 0; i < HISTOGRAM_SIZE; i++)
+			{
+				sum += histogram[i];
+				if (sum >= target)
+				{
+					r = i + 1 < HISTOGRAM_SIZE ? rmin + (i + 1) * width : rmax;
+					break;
+				}
+			}
+		}
+
+		if (r <= 0) return 1;
+		return 2 * r;
+	}
+
+	unsigned int SPC_HashGrid::Hash(int cx, int cy) const
+	{
+		unsigned int h = (unsigned int)cx * 73856093u ^ (unsigned int)cy * 19349663u;
+		return h & (tableSize - 1);
+	}
+
+	int SPC_HashGrid::GetCell(Real v) const
+	{
+		return (int)std::floor(v * inverseSize);
+	}
+
+	void SPC_HashGrid::Build(SPC_Circle** circles, int count)
+	{
+		this->circles.assign(circles, circles + count);
+
+		currentSize = cellSize > 0 ? cellSize : TuneCellSize(circles, count, percentile);
+		inverseSize = 1 / currentSize;
+
+		//table size is a power of two, at least twice the circle count
+		unsigned int size = 16;
+		while (size < 2 * (unsigned int)count) size <<= 1;
+		tableSize = size;
+
+		large.clear();
+		unsorted.clear();
+
+		for (int i = 0; i < count; i++)
+		{
+			SPC_Circle* c = circles[i];
+
+			SPC_GridItem item;
+			item.cx = GetCell(c->position.x);
+			item.cy = GetCell(c->position.y);
+			item.index = i;
+			item.min = Vec2(c->position.x - c->radius, c->position.y - c->radius);
+			item.max = Vec2(c->position.x + c->radius, c->position.y + c->radius);
+
+			if (2 * c->radius > currentSize)
+				large.push_back(item);
+			else
+				unsorted.push_back(item);
+		}
+
+		//counting sort by bucket
+		buckets.assign(tableSize + 1, 0);
+		for (auto& item : unsorted)
+			buckets[Hash(item.cx, item.cy)]++;
+
+		unsigned int sum = 0;
+		for (unsigned int i = 0; i <= tableSize; i++)
+		{
+			sum += buckets[i];
+			buckets[i] = sum; //end of the bucket
+		}
+
+		items.resize(unsorted.size());
+		for (int i = (int)unsorted.size() - 1; i >= 0; i--) //backwards, to keep the circle order in each bucket
+			items[--buckets[Hash(unsorted[i].cx, unsorted[i].cy)]] = unsorted[i];
+
+		unsigned int n = (unsigned int)items.size();
+		itemMinX.resize(n);
+		itemMinY.resize(n);
+		itemMaxX.resize(n);
+		itemMaxY.resize(n);
+
+		for (unsigned int i = 0; i < n; i++)
+		{
+			itemMinX[i] = items[i].min.x;
+			itemMinY[i] = items[i].min.y;
+			itemMaxX[i] = items[i].max.x;
+			itemMaxY[i] = items[i].max.y;
+		}
+	}
+
+	unsigned int SPC_HashGrid::ScanItems(Vec2 min, Vec2 max, unsigned int begin) const
+	{
+		unsigned int mask;
+		int count = (int)std::min((unsigned int)items.size() - begin, 32u);
+		Collision::AABB_to_AABBs(min, max, itemMinX.data() + begin, itemMinY.data() + begin, itemMaxX.data() + begin, itemMaxY.data() + begin, count, &mask);
+		return mask;
+	}
+
+	SPC_Circle* SPC_HashGrid::GetCircle(int index) const
+	{
+		assert(0 <= index && index < (int)circles.size());
+		return circles[index];
+	}
+
+	Real SPC_HashGrid::GetCellSize() const
+	{
+		return currentSize;
+	}
+
+	void SPC_HashGrid::Query(SPC_AABB aabb, SPC_QueryCallback callback, void* data)
+	{
+		if (tableSize == 0) return;
+
+		SPC_GridItem query;
+		query.min = aabb.min;
+		query.max = aabb.max;
+
+		for (auto& item : large)
+			if (ItemOverlap(item, query))
+				if (!callback(item.index, circles[item.index], data))
+					return;
+
+		//centers of the overlapping circles are at most half a cell out of the aabb
+		Real half = currentSize / 2;
+		int x1 = GetCell(aabb.min.x - half), x2 = GetCell(aabb.max.x + half);
+		int y1 = GetCell(aabb.min.y - half), y2 = GetCell(aabb.max.y + half);
+
+		if ((Real)(x2 - x1 + 1) * (y2 - y1 + 1) > items.size()) //cheaper to check every circle
+		{
+			for (unsigned int w = 0; w < items.size(); w += 32)
+				for (unsigned int bits = ScanItems(query.min, query.max, w), i = w; bits; bits >>= 1, i++)
+					if (bits & 1)
+						if (!callback(items[i].index, circles[items[i].index], data))
+							return;
+			return;
+		}
+
+		for (int cy = y1; cy <= y2; cy++)
+			for (int cx = x1; cx <= x2; cx++)
+			{
+				unsigned int h = Hash(cx, cy);
+				for (unsigned int i = buckets[h]; i < buckets[h + 1]; i++)
+				{
+					const SPC_GridItem& item = items[i];
+					if (item.cx != cx || item.cy != cy) continue; //other cell in the same bucket
+
+					if (ItemOverlap(item, query))
+						if (!callback(item.index, circles[item.index], data))
+							return;
+				}
+			}
+	}
+
+	void SPC_HashGrid::QueryPairs(SPC_PairCallback callback, void* data)
+	{
+		if (tableSize == 0) return;
+
+		//half of the neighbour cells. the other half visits this cell
+		static const int offsets[4][2] = { { 1, 0 }, { -1, 1 }, { 0, 1 }, { 1, 1 } };
+
+		SPC_Manifold pair;
+		unsigned int n = (unsigned int)items.size();
+
+		for (unsigned int i = 0; i < n; i++)
+		{
+			const SPC_GridItem& a = items[i];
+			unsigned int h = Hash(a.cx, a.cy);
+
+			//same cell. later items only, so the pair is reported once
+			for (unsigned int j = i + 1; j < buckets[h + 1]; j++)
+			{
+				const SPC_GridItem& b = items[j];
+				if (b.cx != a.cx || b.cy != a.cy || !ItemOverlap(a, b)) continue;
+
+				pair.A = circles[std::min(a.index, b.index)];
+				pair.B = circles[std::max(a.index, b.index)];
+				pair.contact_count = 0;
+				callback(&pair, data);
+			}
+
+			for (int k = 0; k < 4; k++)
+			{
+				int cx = a.cx + offsets[k][0], cy = a.cy + offsets[k][1];
+				unsigned int nh = Hash(cx, cy);
+
+				for (unsigned int j = buckets[nh]; j < buckets[nh + 1]; j++)
+				{
+					const SPC_GridItem& b = items[j];
+					if (b.cx != cx || b.cy != cy || !ItemOverlap(a, b)) continue;
+
+					pair.A = circles[std::min(a.index, b.index)];
+					pair.B = circles[std::max(a.index, b.index)];
+					pair.contact_count = 0;
+					callback(&pair, data);
+				}
+			}
+		}
+
+		//big circles. against each other, then against the cells they cover
+		for (unsigned int i = 0; i < large.size(); i++)
+		{
+			const SPC_GridItem& a = large[i];
+
+			for (unsigned int j = i + 1; j < large.size(); j++)
+			{
+				const SPC_GridItem& b = large[j];
+				if (!ItemOverlap(a, b)) continue;
+
+				pair.A = circles[std::min(a.index, b.index)];
+				pair.B = circles[std::max(a.index, b.index)];
+				pair.contact_count = 0;
+				callback(&pair, data);
+			}
+
+			Real half = currentSize / 2;
+			int x1 = GetCell(a.min.x - half), x2 = GetCell(a.max.x + half);
+			int y1 = GetCell(a.min.y - half), y2 = GetCell(a.max.y + half);
+
+			if ((Real)(x2 - x1 + 1) * (y2 - y1 + 1) > n)
+			{
+				for (unsigned int w = 0; w < n; w += 32)
+					for (unsigned int bits = ScanItems(a.min, a.max, w), j = w; bits; bits >>= 1, j++)
+					{
+						if (!(bits & 1)) continue;
+
+						const SPC_GridItem& b = items[j];
+						pair.A = circles[std::min(a.index, b.index)];
+						pair.B = circles[std::max(a.index, b.index)];
+						pair.contact_count = 0;
+						callback(&pair, data);
+					}
+
+				continue;
+			}
+
+			for (int cy = y1; cy <= y2; cy++)
+				for (int cx = x1; cx <= x2; cx++)
+				{
+					unsigned int nh = Hash(cx, cy);
+					for (unsigned int j = buckets[nh]; j < buckets[nh + 1]; j++)
+					{
+						const SPC_GridItem& b = items[j];
+						if (b.cx != cx || b.cy != cy || !ItemOverlap(a, b)) continue;
+
+						pair.A = circles[std::min(a.index, b.index)];
+						pair.B = circles[std::max(a.index, b.index)];
+						pair.contact_count = 0;
+						callback(&pair, data);
+					}
+				}
+		}
+	}
+
+	void SPC_HashGrid::Clear()
+	{
+		circles.clear();
+		items.clear();
+		buckets.clear();
+		large.clear();
+		unsorted.clear();
+		itemMinX.clear();
+		itemMinY.clear();
+		itemMaxX.clear();
+		itemMaxY.clear();
+		tableSize = 0;
+	}
+}
+#endif
\ No newline at end of file
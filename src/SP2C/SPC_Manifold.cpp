@@ -0,0 +1,16 @@
+#if !defined(SP2C_SINGLE_TU) || defined(__SPC_UNITY__)
+#include <SP2C/SPC_Manifold.h>
+
+namespace SP2C
+{
+	bool SPC_ContactID::operator==(SPC_ContactID id) const
+	{
+		return reference == id.reference && incident == id.incident && flip == id.flip && type == id.type;
+	}
+
+	bool SPC_ContactID::operator!=(SPC_ContactID id) const
+	{
+		return !(*this == id);
+	}
+}
+#endif
\ No newline at end of file
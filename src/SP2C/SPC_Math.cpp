@@ -1,100 +1,151 @@
+#if !defined(SP2C_SINGLE_TU) || defined(__SPC_UNITY__)
 #include <SP2C/SPC_Math.h>
 
 namespace SP2C
 {
-	double DistanceSquared(Vec2 a, Vec2 b)
+	void FirstMax(SIMD::Vector values, SIMD::Vector indices, Real* best, unsigned int* bestIndex)
 	{
-		double x = a.x - b.x, y = a.y - b.y;
-		return x * x + y * y;
-	}
+		Real v[SIMD::WIDTH], k[SIMD::WIDTH];
+		SIMD::Store(v, values);
+		SIMD::Store(k, indices);
 
-	double DotProduct(Vec2 a, Vec2 b)
-	{
-		return a.x * b.x + a.y * b.y;
-	}
+		for (int lane = 0; lane < SIMD::WIDTH; lane++)
+		{
+			if (k[lane] < 0) continue; //nothing was better than the start value in this lane
 
-	double CrossProduct(Vec2 a, Vec2 b)
-	{
-		return a.x * b.y - a.y * b.x;
+			unsigned int index = (unsigned int)k[lane] + lane;
+			if (v[lane] > *best || (v[lane] == *best && index < *bestIndex))
+			{
+				*best = v[lane];
+				*bestIndex = index;
+			}
+		}
 	}
 
-	Vec2 CrossProduct(Vec2 a, double k)
+	Vec2 GetSupport(Vec2 dir, Vec2* vertices, unsigned int n)
 	{
-		return { k * a.y, -k * a.x };
-	}
+		using namespace SIMD;
 
-	Vec2 CrossProduct(double k, Vec2 a)
-	{
-		return { -k * a.y, k * a.x };
-	}
+		Real bestProjection = -REAL_MAX;
+		unsigned int bestIndex = n;
+		unsigned int i = 0;
 
-	double Clamp(double value, double min, double max)
-	{
-		if (value <= min) return min;
-		if (value >= max) return max;
-		return value;
-	}
+		if (n >= (unsigned int)WIDTH)
+		{
+			Vector dx = Set(dir.x), dy = Set(dir.y);
+			Vector best = Set(-REAL_MAX), index = Set(-1);
 
-	double Pythagorean(double a, double b)
-	{
-		return std::sqrt(a * a + b * b);
-	}
+			for (; i + WIDTH <= n; i += WIDTH)
+			{
+				Vector x, y;
+				LoadPairs(&vertices[i].x, &x, &y);
 
-	Vec2 GetSupport(Vec2 dir, Vec2* vertices, unsigned int n)
-	{
-		double bestProjection = -DBL_MAX;
-		Vec2 bestVertex;
+				Vector projection = Add(Mul(x, dx), Mul(y, dy)); //DotProduct(v, dir)
+				Mask better = Greater(projection, best);
 
-		for (unsigned int i = 0; i < n; i++)
+				best = Select(better, projection, best);
+				index = Select(better, Set(i), index);
+			}
+
+			FirstMax(best, index, &bestProjection, &bestIndex);
+		}
+
+		for (; i < n; i++)
 		{
-			Vec2 v = vertices[i];
-			double projection = DotProduct(v, dir);
+			Real projection = DotProduct(vertices[i], dir);
 
 			if (projection > bestProjection)
 			{
-				bestVertex = v;
+				bestIndex = i;
 				bestProjection = projection;
 			}
 		}
 
-		return bestVertex;
+		return bestIndex < n ? vertices[bestIndex] : Vec2();
 	}
 
-	Vec2 ScaleVec(Vec2 origin, Vec2 pivot, double k)
+	Real PseudoAngle(Vec2 v)
 	{
-		Vec2 d = origin - pivot;
-		return pivot + d * k;
-	}
+		if (v.x == 0 && v.y == 0) return 0;
 
-	Vec2 RotateVec(Vec2 origin, Vec2 pivot, double deg)
-	{
-		double rad = deg * Const::RAD;
-		double sin = std::sin(rad), cos = std::cos(rad);
+		if (v.y >= 0)
+			return v.x >= 0 ? v.y / (v.x + v.y) : 1 - v.x / (v.y - v.x);
 
-		SPC_Mat33 T_inv(1, 0, -pivot.x, 0, 1, -pivot.y, 0, 0, 1);
-		SPC_Mat33 R(cos, -sin, 0, sin, cos, 0, 0, 0, 1);
-		SPC_Mat33 T(1, 0, pivot.x, 0, 1, pivot.y, 0, 0, 1);
+		return v.x < 0 ? 2 - v.y / (-v.x - v.y) : 3 + v.x / (v.x - v.y);
+	}
 
-		SPC_Mat33 M = T * R * T_inv;
-		return M * origin;
+	//pseudo angle of v from the direction of n0
+	static inline Real RelativeAngle(Vec2 v, Vec2 n0)
+	{
+		return PseudoAngle(Vec2(DotProduct(v, n0), CrossProduct(n0, v)));
 	}
 
-	double ccwVal(Vec2 a, Vec2 b, Vec2 c)
+	void ComputeNormalAngles(Vec2* normals, unsigned int n, Real* angles)
 	{
-		return a.x * b.y + b.x * c.y + c.x * a.y - (a.y * b.x + b.y * c.x + c.y * a.x);
+		for (unsigned int i = 0; i < n; i++)
+			angles[i] = RelativeAngle(normals[i], normals[0]);
+
+		angles[0] = 0;
 	}
 
-	int ccw(Vec2 a, Vec2 b, Vec2 c)
+	unsigned int GetSupportIndex(Vec2 dir, Vec2* vertices, Vec2* normals, unsigned int n, const Real* angles)
 	{
-		double val = ccwVal(a, b, c);
-		if (val > 0) return 1;
-		else if (val < 0) return -1;
-		return 0;
+		//vertex i is the support for the directions between normals[i - 1] and normals[i].
+		//the angles of the normals grow with the index, so the first normal not behind dir gives the vertex
+		Real target = RelativeAngle(dir, normals[0]);
+		unsigned int low = 0, high = n;
+
+		while (low < high)
+		{
+			unsigned int mid = (low + high) / 2;
+			Real angle = angles ? angles[mid] : (mid == 0 ? 0 : RelativeAngle(normals[mid], normals[0]));
+
+			if (angle < target)
+				low = mid + 1;
+			else
+				high = mid;
+		}
+
+		unsigned int best = low < n ? low : 0;
+
+		//settle ties and rounding with the rule of the linear scan, the lowest index among the largest projections
+		Real bestProjection = DotProduct(vertices[best], dir);
+
+		for (unsigned int k = 0; k < n; k++)
+		{
+			unsigned int prev = best > 0 ? best - 1 : n - 1;
+			unsigned int next = best + 1 < n ? best + 1 : 0;
+			unsigned int moved = best;
+
+			Real p = DotProduct(vertices[prev], dir);
+			if (p > bestProjection || (p == bestProjection && prev < moved))
+			{
+				moved = prev;
+				bestProjection = p;
+			}
+
+			p = DotProduct(vertices[next], dir);
+			if (p > bestProjection || (p == bestProjection && next < moved))
+			{
+				moved = next;
+				bestProjection = p;
+			}
+
+			if (moved == best)
+				break;
+
+			best = moved;
+		}
+
+		return best;
 	}
 
-	bool InsideTriangle(Vec2 t1, Vec2 t2, Vec2 t3, Vec2 p)
+	Vec2 GetSupport(Vec2 dir, Vec2* vertices, Vec2* normals, unsigned int n)
 	{
-		Vec2 a = t2 - t1, b = t3 - t2, c = t1 - t3;
-		return (CrossProduct(a, p - t1) > 0 && CrossProduct(b, p - t2) > 0 && CrossProduct(c, p - t3) > 0);
+		if (n <= SUPPORT_SEARCH_THRESHOLD)
+			return GetSupport(dir, vertices, n);
+
+		return vertices[GetSupportIndex(dir, vertices, normals, n)];
 	}
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,217 @@
+#if !defined(SP2C_SINGLE_TU) || defined(__SPC_UNITY__)
+#include <SP2C/SPC_PairCache.h>
+#include <cstdint>
+
+namespace SP2C
+{
+	static inline bool SameAABB(const SPC_AABB& a, const SPC_AABB& b)
+	{
+		return a.min == b.min && a.max == b.max;
+	}
+
+	SPC_PairCache::SPC_PairCache(int capacity)
+	{
+		count = 0;
+		hits = 0;
+		misses = 0;
+		frame = 0;
+
+		int size = 16;
+		while (size < capacity) size <<= 1;
+		Rehash(size);
+	}
+
+	unsigned int SPC_PairCache::Hash(SPC_Shape* a, SPC_Shape* b) const
+	{
+		unsigned long long h = (unsigned long long)(uintptr_t)a * 0x9E3779B97F4A7C15ull ^ (unsigned long long)(uintptr_t)b * 0xC2B2AE3D27D4EB4Full;
+		h ^= h >> 29;
+		return (unsigned int)h & (unsigned int)(entries.size() - 1);
+	}
+
+	void SPC_PairCache::Rehash(int capacity)
+	{
+		live.clear();
+		for (auto& entry : entries)
+			if (entry.A)
+				live.push_back(entry);
+
+		entries.resize(capacity);
+		for (auto& entry : entries)
+			entry.A = nullptr;
+
+		unsigned int mask = (unsigned int)capacity - 1;
+		for (auto& entry : live)
+		{
+			unsigned int i = Hash(entry.A, entry.B);
+			while (entries[i].A)
+				i = (i + 1) & mask;
+
+			entries[i] = entry;
+		}
+
+		count = (int)live.size();
+	}
+
+	SPC_PairCacheEntry* SPC_PairCache::Find(SPC_Shape* a, SPC_Shape* b)
+	{
+		unsigned int mask = (unsigned int)entries.size() - 1;
+		unsigned int i = Hash(a, b);
+
+		while (entries[i].A)
+		{
+			if (entries[i].A == a && entries[i].B == b)
+				return &entries[i];
+
+			i = (i + 1) & mask;
+		}
+
+		return nullptr;
+	}
+
+	SPC_PairCacheEntry* SPC_PairCache::Insert(SPC_Shape* a, SPC_Shape* b)
+	{
+		//keep the load under a half, so probe sequences stay short
+		if (2 * (count + 1) > (int)entries.size())
+			Rehash((int)entries.size() * 2);
+
+		unsigned int mask = (unsigned int)entries.size() - 1;
+		unsigned int i = Hash(a, b);
+
+		while (entries[i].A)
+			i = (i + 1) & mask;
+
+		SPC_PairCacheEntry& entry = entries[i];
+		entry.A = a;
+		entry.B = b;
+		entry.manifold.A = nullptr;
+		entry.manifold.contact_count = 0;
+		entry.sat.valid = false;
+		entry.matched = 0;
+		entry.touching = false;
+		count++;
+
+		return &entry;
+	}
+
+	bool SPC_PairCache::Collide(SPC_Manifold* m)
+	{
+		SPC_AABB aabbA = ComputeAABB(m->A), aabbB = ComputeAABB(m->B);
+		SPC_PairCacheEntry* entry = Find(m->A, m->B);
+
+		if (entry && entry->manifold.A && SameAABB(entry->aabbA, aabbA) && SameAABB(entry->aabbB, aabbB))
+		{
+			*m = entry->manifold;
+			entry->frame = frame;
+			hits++;
+			return entry->touching;
+		}
+
+		if (!entry)
+			entry = Insert(m->A, m->B);
+
+		misses++;
+		bool touching = Collision::Collide(m, &entry->sat);
+
+		//put contacts with known feature ids in the slots they had last time
+		unsigned int matched = 0;
+		if (touching && entry->touching)
+		{
+			const SPC_Manifold& old = entry->manifold;
+
+			if (m->contact_count == 2 && old.contact_count == 2 && (m->ids[0] == old.ids[1] || m->ids[1] == old.ids[0]))
+			{
+				std::swap(m->contact_points[0], m->contact_points[1]);
+				std::swap(m->ids[0], m->ids[1]);
+			}
+
+			for (unsigned int i = 0; i < m->contact_count; i++)
+				for (unsigned int j = 0; j < old.contact_count; j++)
+					if (m->ids[i] == old.ids[j])
+						matched |= 1u << i;
+		}
+
+		entry->manifold = *m;
+		entry->aabbA = aabbA;
+		entry->aabbB = aabbB;
+		entry->axis = m->normal;
+		entry->matched = matched;
+		entry->frame = frame;
+		entry->touching = touching;
+
+		return touching;
+	}
+
+	int SPC_PairCache::CollideAll(SPC_Manifold* pairs, int count)
+	{
+		int collided = 0;
+		for (int i = 0; i < count; i++)
+		{
+			if (!Collide(&pairs[i]))
+				continue;
+
+			if (collided != i)
+				pairs[collided] = pairs[i];
+
+			collided++;
+		}
+
+		return collided;
+	}
+
+	void SPC_PairCache::EndFrame()
+	{
+		bool stale = false;
+		for (auto& entry : entries)
+			if (entry.A && entry.frame != frame)
+			{
+				entry.A = nullptr;
+				stale = true;
+			}
+
+		//removing from a linear probing table breaks the probe sequences, so the table is built again
+		if (stale)
+			Rehash((int)entries.size());
+
+		frame++;
+		hits = 0;
+		misses = 0;
+	}
+
+	void SPC_PairCache::Invalidate(SPC_Shape* shape)
+	{
+		for (auto& entry : entries)
+			if (entry.A && (entry.A == shape || entry.B == shape))
+				entry.manifold.A = nullptr;
+	}
+
+	int SPC_PairCache::GetCount() const
+	{
+		return count;
+	}
+
+	int SPC_PairCache::GetCapacity() const
+	{
+		return (int)entries.size();
+	}
+
+	int SPC_PairCache::GetHits() const
+	{
+		return hits;
+	}
+
+	int SPC_PairCache::GetMisses() const
+	{
+		return misses;
+	}
+
+	void SPC_PairCache::Clear()
+	{
+		for (auto& entry : entries)
+			entry.A = nullptr;
+
+		count = 0;
+		hits = 0;
+		misses = 0;
+	}
+}
+#endif
\ No newline at end of file
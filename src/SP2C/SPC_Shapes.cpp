@@ -1,4 +1,8 @@
+#if !defined(SP2C_SINGLE_TU) || defined(__SPC_UNITY__)
 #include <SP2C/SPC_Shapes.h>
+#include <SP2C/SPC_Batch.h>
+#include <mutex>
+#include <vector>
 
 namespace SP2C
 {
@@ -46,13 +50,13 @@ namespace SP2C
 		vertices[3] = Vec2(min.x, max.y);
 	}
 
-	void SPC_AABB::SetBox(double w, double h)
+	void SPC_AABB::SetBox(Real w, Real h)
 	{
 		min = Vec2(0, 0);
 		max = Vec2(w, h);
 	}
 
-	void SPC_AABB::Translate(double x, double y)
+	void SPC_AABB::Translate(Real x, Real y)
 	{
 		min.x += x, min.y += y;
 		max.x += x, max.y += y;
@@ -64,7 +68,7 @@ namespace SP2C
 		max += p;
 	}
 
-	void SPC_AABB::Scale(double k)
+	void SPC_AABB::Scale(Real k)
 	{
 		//Vec2 pivot = GetCenter();
 		min = ScaleVec(min, VEC_ZERO, k);
@@ -131,7 +135,7 @@ namespace SP2C
 		return a.CombineAs(b);
 	}
 
-	double GetArea(SPC_AABB a)
+	Real GetArea(SPC_AABB a)
 	{
 		return (a.max.x - a.min.x) * (a.max.y - a.min.y);
 	}
@@ -146,7 +150,7 @@ namespace SP2C
 	/////
 	///// SPC_Circle
 
-	SPC_Circle::SPC_Circle(double r, Vec2 p) : radius(r), position(p)
+	SPC_Circle::SPC_Circle(Real r, Vec2 p) : radius(r), position(p)
 	{
 		type = ShapeType::Circle;
 	}
@@ -169,7 +173,7 @@ namespace SP2C
 		return SPC_AABB(Vec2(position.x - radius, position.y - radius), Vec2(position.x + radius, position.y + radius));
 	}
 
-	void SPC_Circle::Translate(double x, double y)
+	void SPC_Circle::Translate(Real x, Real y)
 	{
 		position.x += x;
 		position.y += y;
@@ -180,7 +184,7 @@ namespace SP2C
 		position += p;
 	}
 
-	void SPC_Circle::Scale(double k)
+	void SPC_Circle::Scale(Real k)
 	{
 		radius *= k;
 	}
@@ -190,7 +194,7 @@ namespace SP2C
 		position.x = position.x + matrix.m[0][2];
 		position.y = position.y + matrix.m[1][2];
 
-		double rot = 1; //for rotation
+		Real rot = 1; //for rotation
 		if (matrix.m[1][0] != 0) rot = std::sqrt(1 - matrix.m[1][0] * matrix.m[1][0]); //sin to cos
 		radius = radius * std::max(matrix.m[0][0], matrix.m[1][1]) / rot;
 	}
@@ -205,15 +209,71 @@ namespace SP2C
 	/////
 	///// SPC_Polygon
 
+	//blocks of (16 << k) vertices followed by as many normals. a freed block waits in the list of its size for the next polygon.
+	//the pool is never destroyed, so polygons in static storage can still return their blocks at exit
+	struct SPC_PolygonPool
+	{
+		static const unsigned int MIN_BLOCK = 16;
+		static const unsigned int SIZES = 27;
+
+		std::mutex lock;
+		std::vector<Vec2*> blocks[SIZES];
+	};
+
+	static SPC_PolygonPool& GetPolygonPool()
+	{
+		static SPC_PolygonPool* pool = new SPC_PolygonPool;
+		return *pool;
+	}
+
+	static unsigned int GetBlockSize(unsigned int capacity)
+	{
+		unsigned int k = 0;
+		while ((SPC_PolygonPool::MIN_BLOCK << k) != capacity) k++;
+		return k;
+	}
+
+	static Vec2* AllocateBlock(unsigned int capacity)
+	{
+		SPC_PolygonPool& pool = GetPolygonPool();
+		std::vector<Vec2*>& list = pool.blocks[GetBlockSize(capacity)];
+		{
+			std::lock_guard<std::mutex> guard(pool.lock);
+			if (!list.empty())
+			{
+				Vec2* block = list.back();
+				list.pop_back();
+				return block;
+			}
+		}
+
+		return new Vec2[2 * capacity];
+	}
+
+	static void FreeBlock(Vec2* block, unsigned int capacity)
+	{
+		SPC_PolygonPool& pool = GetPolygonPool();
+		std::lock_guard<std::mutex> guard(pool.lock);
+		pool.blocks[GetBlockSize(capacity)].push_back(block);
+	}
+
 	SPC_Polygon::SPC_Polygon()
 	{
 		type = ShapeType::Polygon;
 		vertexCount = 0;
+		capacity = INLINE_POLY;
+		vertices = inlineVertices;
+		normals = inlineNormals;
 	}
 
 	SPC_Polygon::SPC_Polygon(const SPC_Polygon& polygon)
 	{
 		type = ShapeType::Polygon;
+		capacity = INLINE_POLY;
+		vertices = inlineVertices;
+		normals = inlineNormals;
+
+		Reserve(polygon.vertexCount);
 		vertexCount = polygon.vertexCount;
 
 		for (unsigned int i = 0; i < vertexCount; i++)
@@ -223,18 +283,37 @@ namespace SP2C
 		}
 	}
 
+	SPC_Polygon::~SPC_Polygon()
+	{
+		if (vertices != inlineVertices)
+			FreeBlock(vertices, capacity);
+	}
+
 	SPC_Shape* SPC_Polygon::Clone() const
 	{
-		SPC_Polygon* polygon = new SPC_Polygon;
-		polygon->vertexCount = vertexCount;
+		return new SPC_Polygon(*this);
+	}
+
+	void SPC_Polygon::Reserve(unsigned int count)
+	{
+		if (count <= capacity)
+			return;
 
-		for (unsigned int i = 0; i < vertexCount; i++)
-		{
-			polygon->vertices[i] = vertices[i];
-			polygon->normals[i] = normals[i];
-		}
+		unsigned int size = SPC_PolygonPool::MIN_BLOCK;
+		while (size < count) size <<= 1;
+
+		Vec2* block = AllocateBlock(size);
+		if (vertices != inlineVertices)
+			FreeBlock(vertices, capacity);
+
+		capacity = size;
+		vertices = block;
+		normals = block + size;
+	}
 
-		return polygon;
+	unsigned int SPC_Polygon::GetCapacity() const
+	{
+		return capacity;
 	}
 
 	Vec2 SPC_Polygon::GetCenter()
@@ -251,15 +330,15 @@ namespace SP2C
 	void SPC_Polygon::Set(Vec2* v, unsigned int count, bool ordering)
 	{
 		assert(count > 2);
-		count = std::min((int)count, MAX_POLY);
+		Reserve(count);
 
 		if (ordering) //vertices need to be ordered
 		{
 			int rightMost = 0;
-			double highestX = v[0].x;
+			Real highestX = v[0].x;
 			for (unsigned int i = 1; i < count; i++)
 			{
-				double x = v[i].x;
+				Real x = v[i].x;
 				if (x > highestX)
 				{
 					highestX = x;
@@ -270,13 +349,13 @@ namespace SP2C
 						rightMost = i;
 			}
 
-			int hull[MAX_POLY];
-			int outCount = 0;
+			//the hull is written to vertices directly. it has count vertices at most
+			unsigned int outCount = 0;
 			int indexHull = rightMost;
 
 			while (true)
 			{
-				hull[outCount] = indexHull;
+				vertices[outCount] = v[indexHull];
 
 				int nextHullIndex = 0;
 				for (unsigned int i = 1; i < count; i++)
@@ -287,9 +366,9 @@ namespace SP2C
 						continue;
 					}
 
-					Vec2 e1 = v[nextHullIndex] - v[hull[outCount]];
-					Vec2 e2 = v[i] - v[hull[outCount]];
-					double c = CrossProduct(e1, e2);
+					Vec2 e1 = v[nextHullIndex] - v[indexHull];
+					Vec2 e2 = v[i] - v[indexHull];
+					Real c = CrossProduct(e1, e2);
 					if (c < 0)
 						nextHullIndex = i;
 
@@ -299,15 +378,12 @@ namespace SP2C
 
 				outCount++;
 				indexHull = nextHullIndex;
-				if (nextHullIndex == rightMost)
+				if (nextHullIndex == rightMost || outCount == count)
 				{
 					vertexCount = outCount;
 					break;
 				}
 			}
-
-			for (unsigned int i = 0; i < vertexCount; i++)
-				vertices[i] = v[hull[i]];
 		}
 		else //just put vertices in original order
 		{
@@ -327,7 +403,7 @@ namespace SP2C
 		}
 	}
 
-	void SPC_Polygon::SetBox(double w, double h)
+	void SPC_Polygon::SetBox(Real w, Real h)
 	{
 		vertexCount = 4;
 		vertices[0] = { 0, 0 };
@@ -341,7 +417,7 @@ namespace SP2C
 		normals[3] = { -1, 0 };
 	}
 
-	void SPC_Polygon::Translate(double x, double y)
+	void SPC_Polygon::Translate(Real x, Real y)
 	{
 		for (unsigned int i = 0; i < vertexCount; i++)
 			vertices[i].x += x, vertices[i].y += y;
@@ -353,20 +429,22 @@ namespace SP2C
 			vertices[i] += p;
 	}
 
-	void SPC_Polygon::Scale(double k)
+	void SPC_Polygon::Scale(Real k)
 	{
 		//Vec2 pivot = GetCenter();
 		for (unsigned int i = 0; i < vertexCount; i++)
 			vertices[i] = ScaleVec(vertices[i], VEC_ZERO, k);
 	}
 
-	void SPC_Polygon::Rotate(double deg)
+	void SPC_Polygon::Rotate(Real deg)
 	{
 		//Vec2 pivot = GetCenter();
+		//sin and cos once for every vertex. keep the polygon in local space with an SPC_Transform2D to skip this loop
+		SPC_Transform2D rotation(VEC_ZERO, deg);
 		for (unsigned int i = 0; i < vertexCount; i++)
 		{
-			vertices[i] = RotateVec(vertices[i], VEC_ZERO, deg); //RotateVec(vertices[i], pivot, deg);
-			normals[i] = RotateVec(normals[i], VEC_ZERO, deg);
+			vertices[i] = rotation.ApplyRotation(vertices[i]);
+			normals[i] = rotation.ApplyRotation(normals[i]);
 		}
 	}
 
@@ -391,10 +469,16 @@ namespace SP2C
 		}
 	}
 
+	void SPC_Polygon::Transform(const SPC_Mat23& matrix)
+	{
+		TransformPoints(matrix, vertices, vertexCount);
+		TransformVectors(matrix, normals, vertexCount);
+	}
+
 	SPC_AABB SPC_Polygon::ComputeAABB() const
 	{
-		double x1 = DBL_MAX, x2 = -DBL_MAX;
-		double y1 = DBL_MAX, y2 = -DBL_MAX;
+		Real x1 = REAL_MAX, x2 = -REAL_MAX;
+		Real y1 = REAL_MAX, y2 = -REAL_MAX;
 
 		for (unsigned int i = 0; i < vertexCount; i++)
 		{
@@ -409,6 +493,10 @@ namespace SP2C
 
 	SPC_Polygon& SPC_Polygon::operator=(const SPC_Polygon& polygon)
 	{
+		if (this == &polygon)
+			return *this;
+
+		Reserve(polygon.vertexCount);
 		vertexCount = polygon.vertexCount;
 
 		for (unsigned int i = 0; i < vertexCount; i++)
@@ -437,4 +525,53 @@ namespace SP2C
 			return SPC_AABB();
 		}
 	}
-}
\ No newline at end of file
+
+	SPC_AABB ComputeAABB(SPC_Shape* shape, const SPC_Transform2D& t)
+	{
+		Vec2 corners[4];
+		Vec2* vertices = corners;
+		unsigned int count = 4;
+
+		switch (shape->type)
+		{
+		case SPC_Shape::AABB:
+		{
+			SPC_AABB* aabb = reinterpret_cast<SPC_AABB*>(shape);
+			if (t.sin == 0 && t.cos == 1)
+				return SPC_AABB(aabb->min + t.position, aabb->max + t.position);
+
+			aabb->GetVertices(corners);
+			break;
+		}
+
+		case SPC_Shape::Circle:
+		{
+			SPC_Circle* circle = reinterpret_cast<SPC_Circle*>(shape);
+			return SPC_Circle(circle->radius, t.Apply(circle->position)).ComputeAABB();
+		}
+
+		case SPC_Shape::Polygon:
+			vertices = reinterpret_cast<SPC_Polygon*>(shape)->vertices;
+			count = reinterpret_cast<SPC_Polygon*>(shape)->vertexCount;
+			break;
+
+		default:
+			return SPC_AABB();
+		}
+
+		Real x1 = REAL_MAX, x2 = -REAL_MAX;
+		Real y1 = REAL_MAX, y2 = -REAL_MAX;
+
+		for (unsigned int i = 0; i < count; i++)
+		{
+			Vec2 v = t.Apply(vertices[i]);
+			x1 = std::min(x1, v.x);
+			x2 = std::max(x2, v.x);
+			y1 = std::min(y1, v.y);
+			y2 = std::max(y2, v.y);
+		}
+
+		return SPC_AABB(Vec2(x1, y1), Vec2(x2, y2));
+	}
+}
+#endif
\ No newline at end of file
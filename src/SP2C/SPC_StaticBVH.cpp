@@ -0,0 +1,486 @@
+#if !defined(SP2C_SINGLE_TU) || defined(__SPC_UNITY__)
+#include <SP2C/SPC_StaticBVH.h>
+
+namespace SP2C
+{
+	static inline Real BoundsArea(Vec2 min, Vec2 max)
+	{
+		return (max.x - min.x) * (max.y - min.y);
+	}
+
+	static inline bool BoundsOverlap(Vec2 minA, Vec2 maxA, Vec2 minB, Vec2 maxB)
+	{
+		//same test as Collision::AABB_to_AABB
+		if (maxA.x < minB.x || minA.x > maxB.x) return false;
+		if (maxA.y < minB.y || minA.y > maxB.y) return false;
+		return true;
+	}
+
+	static inline unsigned int SpreadBits(unsigned int v) //put a zero bit between the lower 16 bits
+	{
+		v &= 0x0000ffff;
+		v = (v | (v << 8)) & 0x00ff00ff;
+		v = (v | (v << 4)) & 0x0f0f0f0f;
+		v = (v | (v << 2)) & 0x33333333;
+		v = (v | (v << 1)) & 0x55555555;
+		return v;
+	}
+
+	SPC_StaticBVH::SPC_StaticBVH()
+	{
+		leafSize = 2;
+	}
+
+	void SPC_StaticBVH::Build(SPC_Shape** shapes, int count, BuildMethod method, int leafSize)
+	{
+		this->leafSize = std::max(1, std::min(leafSize, (int)MAX_LEAF_SIZE));
+
+		nodes.clear();
+		primitives.resize(count);
+
+		for (int i = 0; i < count; i++)
+		{
+			SPC_AABB aabb = ComputeAABB(shapes[i]);
+			primitives[i].min = aabb.min;
+			primitives[i].max = aabb.max;
+			primitives[i].shape = shapes[i];
+			primitives[i].index = i;
+		}
+
+		if (count == 0) return;
+
+		nodes.reserve(2 * count);
+
+		if (method == Morton)
+		{
+			Vec2 cmin = (primitives[0].min + primitives[0].max) * 0.5, cmax = cmin;
+			for (auto& p : primitives)
+			{
+				Vec2 c = (p.min + p.max) * 0.5;
+				cmin.x = std::min(cmin.x, c.x), cmin.y = std::min(cmin.y, c.y);
+				cmax.x = std::max(cmax.x, c.x), cmax.y = std::max(cmax.y, c.y);
+			}
+
+			Vec2 extent = cmax - cmin;
+			Real sx = extent.x > 0 ? 65535 / extent.x : 0;
+			Real sy = extent.y > 0 ? 65535 / extent.y : 0;
+
+			std::vector<std::pair<unsigned int, int>> keys(count);
+			for (int i = 0; i < count; i++)
+			{
+				Vec2 c = (primitives[i].min + primitives[i].max) * 0.5;
+				unsigned int qx = (unsigned int)((c.x - cmin.x) * sx);
+				unsigned int qy = (unsigned int)((c.y - cmin.y) * sy);
+				keys[i] = { SpreadBits(qx) | (SpreadBits(qy) << 1), i };
+			}
+
+			std::sort(keys.begin(), keys.end());
+
+			std::vector<SPC_BVHPrimitive> sorted(count);
+			codes.resize(count);
+
+			for (int i = 0; i < count; i++)
+			{
+				sorted[i] = primitives[keys[i].second];
+				codes[i] = keys[i].first;
+			}
+
+			primitives.swap(sorted);
+			BuildMorton(0, count);
+			codes.clear();
+		}
+		else
+			BuildSAH(0, count);
+
+		int padded = count + SIMD::WIDTH - 1;
+		boundsMinX.assign(padded, 0);
+		boundsMinY.assign(padded, 0);
+		boundsMaxX.assign(padded, 0);
+		boundsMaxY.assign(padded, 0);
+
+		for (int i = 0; i < count; i++)
+		{
+			boundsMinX[i] = primitives[i].min.x;
+			boundsMinY[i] = primitives[i].min.y;
+			boundsMaxX[i] = primitives[i].max.x;
+			boundsMaxY[i] = primitives[i].max.y;
+		}
+	}
+
+	int SPC_StaticBVH::MakeNode(int begin, int end, bool leaf)
+	{
+		SPC_BVHNode node;
+		node.min = primitives[begin].min;
+		node.max = primitives[begin].max;
+
+		for (int i = begin + 1; i < end; i++)
+		{
+			node.min.x = std::min(node.min.x, primitives[i].min.x);
+			node.min.y = std::min(node.min.y, primitives[i].min.y);
+			node.max.x = std::max(node.max.x, primitives[i].max.x);
+			node.max.y = std::max(node.max.y, primitives[i].max.y);
+		}
+
+		node.start = begin;
+		node.count = leaf ? end - begin : 0;
+
+		int index = (int)nodes.size();
+		node.escape = index + 1; //fixed after the children for branches
+		nodes.push_back(node);
+		return index;
+	}
+
+	int SPC_StaticBVH::BuildSAH(int begin, int end)
+	{
+		int count = end - begin;
+		if (count <= leafSize)
+			return MakeNode(begin, end, true);
+
+		Vec2 cmin = (primitives[begin].min + primitives[begin].max) * 0.5, cmax = cmin;
+		Vec2 nmin = primitives[begin].min, nmax = primitives[begin].max;
+
+		for (int i = begin + 1; i < end; i++)
+		{
+			Vec2 c = (primitives[i].min + primitives[i].max) * 0.5;
+			cmin.x = std::min(cmin.x, c.x), cmin.y = std::min(cmin.y, c.y);
+			cmax.x = std::max(cmax.x, c.x), cmax.y = std::max(cmax.y, c.y);
+
+			nmin.x = std::min(nmin.x, primitives[i].min.x), nmin.y = std::min(nmin.y, primitives[i].min.y);
+			nmax.x = std::max(nmax.x, primitives[i].max.x), nmax.y = std::max(nmax.y, primitives[i].max.y);
+		}
+
+		int bestAxis = -1, bestBin = 0;
+		Real bestCost = REAL_MAX;
+
+		for (int axis = 0; axis < 2; axis++)
+		{
+			Real lo = axis == 0 ? cmin.x : cmin.y;
+			Real extent = axis == 0 ? cmax.x - cmin.x : cmax.y - cmin.y;
+			if (extent <= 0) continue;
+
+			int binCount[BIN_COUNT] = { 0 };
+			Vec2 binMin[BIN_COUNT], binMax[BIN_COUNT];
+
+			for (int i = begin; i < end; i++)
+			{
+				Vec2 c = (primitives[i].min + primitives[i].max) * 0.5;
+				int b = (int)(((axis == 0 ? c.x : c.y) - lo) / extent * BIN_COUNT);
+				b = std::min(b, BIN_COUNT - 1);
+
+				if (binCount[b]++ == 0)
+				{
+					binMin[b] = primitives[i].min;
+					binMax[b] = primitives[i].max;
+				}
+				else
+				{
+					binMin[b].x = std::min(binMin[b].x, primitives[i].min.x), binMin[b].y = std::min(binMin[b].y, primitives[i].min.y);
+					binMax[b].x = std::max(binMax[b].x, primitives[i].max.x), binMax[b].y = std::max(binMax[b].y, primitives[i].max.y);
+				}
+			}
+
+			//area and count on the right side of each split, swept from the right
+			Real rightArea[BIN_COUNT];
+			int rightCount[BIN_COUNT];
+			Vec2 rmin, rmax;
+			int rcount = 0;
+
+			for (int b = BIN_COUNT - 1; b > 0; b--)
+			{
+				if (binCount[b])
+				{
+					if (rcount == 0) rmin = binMin[b], rmax = binMax[b];
+					else
+					{
+						rmin.x = std::min(rmin.x, binMin[b].x), rmin.y = std::min(rmin.y, binMin[b].y);
+						rmax.x = std::max(rmax.x, binMax[b].x), rmax.y = std::max(rmax.y, binMax[b].y);
+					}
+					rcount += binCount[b];
+				}
+
+				rightCount[b] = rcount;
+				rightArea[b] = rcount ? BoundsArea(rmin, rmax) : 0;
+			}
+
+			Vec2 lmin, lmax;
+			int lcount = 0;
+
+			for (int b = 0; b < BIN_COUNT - 1; b++) //split between bin b and b + 1
+			{
+				if (binCount[b])
+				{
+					if (lcount == 0) lmin = binMin[b], lmax = binMax[b];
+					else
+					{
+						lmin.x = std::min(lmin.x, binMin[b].x), lmin.y = std::min(lmin.y, binMin[b].y);
+						lmax.x = std::max(lmax.x, binMax[b].x), lmax.y = std::max(lmax.y, binMax[b].y);
+					}
+					lcount += binCount[b];
+				}
+
+				if (lcount == 0 || rightCount[b + 1] == 0) continue;
+
+				Real cost = lcount * BoundsArea(lmin, lmax) + rightCount[b + 1] * rightArea[b + 1];
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestAxis = axis;
+					bestBin = b;
+				}
+			}
+		}
+
+		int mid;
+
+		if (bestAxis == -1) //every center is at the same point
+		{
+			if (count <= MAX_LEAF_SIZE)
+				return MakeNode(begin, end, true);
+
+			mid = (begin + end) / 2;
+		}
+		else
+		{
+			if (bestCost >= count * BoundsArea(nmin, nmax) && count <= MAX_LEAF_SIZE)
+				return MakeNode(begin, end, true);
+
+			Real lo = bestAxis == 0 ? cmin.x : cmin.y;
+			Real extent = bestAxis == 0 ? cmax.x - cmin.x : cmax.y - cmin.y;
+
+			SPC_BVHPrimitive* p = std::partition(primitives.data() + begin, primitives.data() + end, [&](const SPC_BVHPrimitive& prim)
+				{
+					Vec2 c = (prim.min + prim.max) * 0.5;
+					int b = (int)(((bestAxis == 0 ? c.x : c.y) - lo) / extent * BIN_COUNT);
+					return std::min(b, BIN_COUNT - 1) <= bestBin;
+				});
+
+			mid = (int)(p - primitives.data());
+			if (mid == begin || mid == end)
+				mid = (begin + end) / 2;
+		}
+
+		int index = MakeNode(begin, end, false);
+		BuildSAH(begin, mid);
+		BuildSAH(mid, end);
+		nodes[index].escape = (int)nodes.size();
+
+		return index;
+	}
+
+	int SPC_StaticBVH::BuildMorton(int begin, int end)
+	{
+		int count = end - begin;
+		if (count <= leafSize)
+			return MakeNode(begin, end, true);
+
+		unsigned int first = codes[begin], last = codes[end - 1];
+		int mid;
+
+		if (first == last)
+			mid = (begin + end) / 2;
+		else
+		{
+			//split where the highest differing bit changes
+			unsigned int diff = first ^ last;
+			unsigned int bit = 1u << 31;
+			while (!(diff & bit)) bit >>= 1;
+
+			int lo = begin, hi = end - 1; //codes[lo] has the bit cleared, codes[hi] has it set
+			while (hi - lo > 1)
+			{
+				int m = (lo + hi) / 2;
+				if (codes[m] & bit) hi = m;
+				else lo = m;
+			}
+
+			mid = hi;
+		}
+
+		int index = MakeNode(begin, end, false);
+		BuildMorton(begin, mid);
+		BuildMorton(mid, end);
+		nodes[index].escape = (int)nodes.size();
+
+		return index;
+	}
+
+	template <typename Callback>
+	void SPC_StaticBVH::Traverse(Vec2 min, Vec2 max, Callback& callback) const
+	{
+		const SPC_BVHNode* data = nodes.data();
+		int n = (int)nodes.size();
+		int i = 0;
+
+		while (i < n)
+		{
+			const SPC_BVHNode& node = data[i];
+
+			if (!BoundsOverlap(node.min, node.max, min, max))
+			{
+				i = node.escape;
+				continue;
+			}
+
+			if (node.count)
+			{
+				//whole vectors, reading into the next leaf or the padding. those bits are dropped
+				int width = (node.count + SIMD::WIDTH - 1) / SIMD::WIDTH * SIMD::WIDTH;
+				int start = node.start;
+
+				unsigned int mask;
+				Collision::AABB_to_AABBs(min, max, &boundsMinX[start], &boundsMinY[start], &boundsMaxX[start], &boundsMaxY[start], width, &mask);
+
+				for (int k = 0; k < node.count; k++)
+					if (mask >> k & 1)
+						if (!callback(primitives[start + k]))
+							return;
+			}
+
+			i++;
+		}
+	}
+
+	void SPC_StaticBVH::Query(SPC_AABB aabb, SPC_QueryCallback callback, void* data) const
+	{
+		auto visit = [&](const SPC_BVHPrimitive& p)
+		{
+			return callback(p.index, p.shape, data);
+		};
+
+		Traverse(aabb.min, aabb.max, visit);
+	}
+
+	void SPC_StaticBVH::Raycast(Vec2 origin, Vec2 dir, Real maxT, SPC_RayCallback callback, void* data) const
+	{
+		int n = (int)nodes.size();
+		int i = 0;
+
+		while (i < n)
+		{
+			const SPC_BVHNode& node = nodes[i];
+
+			if (!Collision::RayOverlap(node.min, node.max, origin, dir, maxT))
+			{
+				i = node.escape;
+				continue;
+			}
+
+			for (int k = 0; k < node.count; k++)
+			{
+				const SPC_BVHPrimitive& p = primitives[node.start + k];
+				if (!Collision::RayOverlap(p.min, p.max, origin, dir, maxT))
+					continue;
+
+				Real t = callback(p.index, p.shape, maxT, data);
+				if (t <= 0)
+					return;
+
+				maxT = std::min(maxT, t);
+			}
+
+			i++;
+		}
+	}
+
+	int SPC_StaticBVH::Raycast(Vec2 origin, Vec2 dir, Real maxT, SPC_RaycastMode mode, SPC_RaycastHit* hits, int capacity) const
+	{
+		SPC_RaycastResult result = { origin, dir, mode, hits, capacity, 0 };
+		Raycast(origin, dir, maxT, Collision::RaycastShape, &result);
+		return result.count;
+	}
+
+	void SPC_StaticBVH::QueryPairs(SPC_Shape** shapes, int count, SPC_PairCallback callback, void* data) const
+	{
+		SPC_Manifold pair;
+
+		auto visit = [&](const SPC_BVHPrimitive& p)
+		{
+			pair.B = p.shape;
+			pair.contact_count = 0;
+			callback(&pair, data);
+			return true;
+		};
+
+		for (int i = 0; i < count; i++)
+		{
+			SPC_AABB aabb = ComputeAABB(shapes[i]);
+			pair.A = shapes[i];
+			Traverse(aabb.min, aabb.max, visit);
+		}
+	}
+
+	void SPC_StaticBVH::QueryPairs(const SPC_DynamicTree& tree, SPC_PairCallback callback, void* data) const
+	{
+		SPC_Manifold pair;
+
+		auto visit = [&](const SPC_BVHPrimitive& p)
+		{
+			pair.B = p.shape;
+			pair.contact_count = 0;
+			callback(&pair, data);
+			return true;
+		};
+
+		for (auto& node : tree.nodes)
+		{
+			if (node.height != 0) //only leaves
+				continue;
+
+			pair.A = node.shape;
+			Traverse(node.aabb.min, node.aabb.max, visit);
+		}
+	}
+
+	int SPC_StaticBVH::GetNodeCount() const
+	{
+		return (int)nodes.size();
+	}
+
+	int SPC_StaticBVH::GetDepth() const
+	{
+		//open branches are kept by their escape index
+		std::vector<int> open;
+		int depth = 0;
+
+		for (int i = 0; i < (int)nodes.size(); i++)
+		{
+			while (!open.empty() && open.back() <= i)
+				open.pop_back();
+
+			depth = std::max(depth, (int)open.size() + 1);
+
+			if (nodes[i].count == 0)
+				open.push_back(nodes[i].escape);
+		}
+
+		return depth;
+	}
+
+	Real SPC_StaticBVH::GetSAHCost() const
+	{
+		if (nodes.empty()) return 0;
+
+		Real rootArea = BoundsArea(nodes[0].min, nodes[0].max);
+		if (rootArea <= 0) return 0;
+
+		Real cost = 0;
+		for (auto& node : nodes)
+		{
+			Real p = BoundsArea(node.min, node.max) / rootArea;
+			cost += node.count ? p * node.count : p;
+		}
+
+		return cost;
+	}
+
+	void SPC_StaticBVH::Clear()
+	{
+		nodes.clear();
+		primitives.clear();
+		boundsMinX.clear();
+		boundsMinY.clear();
+		boundsMaxX.clear();
+		boundsMaxY.clear();
+	}
+}
+#endif
\ No newline at end of file
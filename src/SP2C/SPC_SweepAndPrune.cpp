@@ -0,0 +1,360 @@
+#if !defined(SP2C_SINGLE_TU) || defined(__SPC_UNITY__)
+#include <SP2C/SPC_SweepAndPrune.h>
+#include <SP2C/SPC_Collision.h>
+#include <SP2C/SPC_ThreadPool.h>
+
+namespace SP2C
+{
+	static inline bool EntryLess(const SPC_SweepEntry& a, const SPC_SweepEntry& b)
+	{
+		return a.min < b.min || (a.min == b.min && a.proxyId < b.proxyId);
+	}
+
+	SPC_SweepAndPrune::SPC_SweepAndPrune(SweepAxis mode) : mode(mode)
+	{
+		freeList = SPC_NULL_PROXY;
+		proxyCount = 0;
+		axis = mode == AxisY ? 1 : 0;
+		sorted = true;
+	}
+
+	void SPC_SweepAndPrune::SetLayout(int count)
+	{
+		if (count != (int)proxies.size() || proxyCount != count) //different layout. start from the array order
+		{
+			proxies.resize(count);
+			entries.resize(count);
+
+			for (int i = 0; i < count; i++)
+			{
+				proxies[i].next = SPC_NULL_PROXY;
+				proxies[i].used = true;
+				entries[i].proxyId = i;
+			}
+
+			freeList = SPC_NULL_PROXY;
+			proxyCount = count;
+			sorted = false;
+		}
+	}
+
+	void SPC_SweepAndPrune::Set(SPC_Shape** shapes, int count)
+	{
+		SetLayout(count);
+
+		for (int i = 0; i < count; i++)
+		{
+			proxies[i].shape = shapes[i];
+			proxies[i].aabb = ComputeAABB(shapes[i]);
+		}
+	}
+
+	struct SPC_SweepJob
+	{
+		SPC_SweepAndPrune* sap;
+		SPC_Shape** shapes;
+		int count;
+		int chunkCount;
+	};
+
+	static void SetChunk(int task, int /*worker*/, void* data)
+	{
+		SPC_SweepJob* job = reinterpret_cast<SPC_SweepJob*>(data);
+
+		int begin = (int)((long long)job->count * task / job->chunkCount);
+		int end = (int)((long long)job->count * (task + 1) / job->chunkCount);
+
+		for (int i = begin; i < end; i++)
+		{
+			job->sap->proxies[i].shape = job->shapes[i];
+			job->sap->proxies[i].aabb = ComputeAABB(job->shapes[i]);
+		}
+	}
+
+	void SPC_SweepAndPrune::Set(SPC_Shape** shapes, int count, SPC_ThreadPool& pool)
+	{
+		SetLayout(count);
+
+		SPC_SweepJob job = { this, shapes, count, std::min(pool.GetWorkerCount() * 8, count / MIN_CHUNK_SIZE + 1) };
+		pool.Run(job.chunkCount, SetChunk, &job);
+	}
+
+	int SPC_SweepAndPrune::CreateProxy(SPC_Shape* shape)
+	{
+		return CreateProxy(ComputeAABB(shape), shape);
+	}
+
+	int SPC_SweepAndPrune::CreateProxy(const SPC_AABB& aabb, SPC_Shape* shape)
+	{
+		int proxyId;
+
+		if (freeList != SPC_NULL_PROXY)
+		{
+			proxyId = freeList;
+			freeList = proxies[proxyId].next;
+		}
+		else
+		{
+			proxyId = (int)proxies.size();
+			proxies.emplace_back();
+		}
+
+		SPC_SweepProxy& proxy = proxies[proxyId];
+		proxy.aabb = aabb;
+		proxy.shape = shape;
+		proxy.next = SPC_NULL_PROXY;
+		proxy.used = true;
+
+		//new entries go to the end. the next sort moves them into place
+		SPC_SweepEntry entry;
+		entry.min = axis == 0 ? aabb.min.x : aabb.min.y;
+		entry.max = axis == 0 ? aabb.max.x : aabb.max.y;
+		entry.proxyId = proxyId;
+		entries.push_back(entry);
+
+		proxyCount++;
+		return proxyId;
+	}
+
+	void SPC_SweepAndPrune::DestroyProxy(int proxyId)
+	{
+		assert(0 <= proxyId && proxyId < (int)proxies.size());
+		assert(proxies[proxyId].used);
+
+		//keep the order of the other entries
+		for (unsigned int i = 0; i < entries.size(); i++)
+			if (entries[i].proxyId == proxyId)
+			{
+				entries.erase(entries.begin() + i);
+				break;
+			}
+
+		proxies[proxyId].used = false;
+		proxies[proxyId].shape = nullptr;
+		proxies[proxyId].next = freeList;
+		freeList = proxyId;
+		proxyCount--;
+	}
+
+	void SPC_SweepAndPrune::MoveProxy(int proxyId, const SPC_AABB& aabb)
+	{
+		assert(0 <= proxyId && proxyId < (int)proxies.size());
+		assert(proxies[proxyId].used);
+		proxies[proxyId].aabb = aabb;
+	}
+
+	void SPC_SweepAndPrune::UpdateProxy(int proxyId)
+	{
+		assert(0 <= proxyId && proxyId < (int)proxies.size());
+		assert(proxies[proxyId].used);
+		proxies[proxyId].aabb = ComputeAABB(proxies[proxyId].shape);
+	}
+
+	void SPC_SweepAndPrune::UpdateAll()
+	{
+		for (auto& proxy : proxies)
+			if (proxy.used)
+				proxy.aabb = ComputeAABB(proxy.shape);
+	}
+
+	SPC_Shape* SPC_SweepAndPrune::GetShape(int proxyId) const
+	{
+		assert(0 <= proxyId && proxyId < (int)proxies.size());
+		return proxies[proxyId].shape;
+	}
+
+	const SPC_AABB& SPC_SweepAndPrune::GetAABB(int proxyId) const
+	{
+		assert(0 <= proxyId && proxyId < (int)proxies.size());
+		return proxies[proxyId].aabb;
+	}
+
+	int SPC_SweepAndPrune::ChooseAxis() const
+	{
+		if (mode != AxisAuto)
+			return mode == AxisY ? 1 : 0;
+
+		if (proxyCount < 2)
+			return axis;
+
+		Vec2 sum, sum2;
+		for (auto& proxy : proxies)
+		{
+			if (!proxy.used) continue;
+
+			Vec2 c = proxy.aabb.GetCenter();
+			sum += c;
+			sum2 += Vec2(c.x * c.x, c.y * c.y);
+		}
+
+		Vec2 variance = sum2 / proxyCount - Vec2(sum.x * sum.x, sum.y * sum.y) / ((Real)proxyCount * proxyCount);
+		return variance.y > variance.x ? 1 : 0;
+	}
+
+	void SPC_SweepAndPrune::Sort()
+	{
+		int newAxis = ChooseAxis();
+
+		for (auto& entry : entries)
+		{
+			const SPC_AABB& aabb = proxies[entry.proxyId].aabb;
+			entry.min = newAxis == 0 ? aabb.min.x : aabb.min.y;
+			entry.max = newAxis == 0 ? aabb.max.x : aabb.max.y;
+		}
+
+		if (newAxis != axis || !sorted) //the previous order is useless
+		{
+			axis = newAxis;
+			sorted = true;
+			std::sort(entries.begin(), entries.end(), EntryLess);
+			return;
+		}
+
+		//insertion sort. almost linear as the order from the last frame is nearly sorted
+		unsigned int n = (unsigned int)entries.size();
+		unsigned int moves = 0, maxMoves = 16 * n;
+
+		for (unsigned int i = 1; i < n; i++)
+		{
+			SPC_SweepEntry key = entries[i];
+			unsigned int j = i;
+
+			while (j > 0 && EntryLess(key, entries[j - 1]))
+			{
+				entries[j] = entries[j - 1];
+				j--;
+				moves++;
+			}
+
+			entries[j] = key;
+
+			if (moves > maxMoves) //too far from sorted. insertion sort would be quadratic
+			{
+				std::sort(entries.begin(), entries.end(), EntryLess);
+				return;
+			}
+		}
+	}
+
+	void SPC_SweepAndPrune::Query(SPC_AABB aabb, SPC_QueryCallback callback, void* data)
+	{
+		Sort();
+
+		Real min = axis == 0 ? aabb.min.x : aabb.min.y;
+		Real max = axis == 0 ? aabb.max.x : aabb.max.y;
+
+		for (auto& entry : entries)
+		{
+			if (entry.min > max) break;
+			if (entry.max < min) continue;
+
+			SPC_SweepProxy& proxy = proxies[entry.proxyId];
+			if (Collision::AABB_to_AABB(proxy.aabb, aabb))
+				if (!callback(entry.proxyId, proxy.shape, data))
+					return;
+		}
+	}
+
+	template <typename Report>
+	void SPC_SweepAndPrune::Sweep(unsigned int begin, unsigned int end, Report& report)
+	{
+		unsigned int n = (unsigned int)entries.size();
+
+		for (unsigned int i = begin; i < end; i++)
+		{
+			const SPC_SweepEntry& a = entries[i];
+			SPC_SweepProxy& proxyA = proxies[a.proxyId];
+
+			for (unsigned int j = i + 1; j < n && entries[j].min <= a.max; j++)
+			{
+				const SPC_SweepEntry& b = entries[j];
+				SPC_SweepProxy& proxyB = proxies[b.proxyId];
+
+				if (!Collision::AABB_to_AABB(proxyA.aabb, proxyB.aabb))
+					continue;
+
+				if (a.proxyId < b.proxyId)
+					report(a.proxyId, b.proxyId);
+				else
+					report(b.proxyId, a.proxyId);
+			}
+		}
+	}
+
+	void SPC_SweepAndPrune::QueryPairs(SPC_PairCallback callback, void* data)
+	{
+		Sort();
+
+		SPC_Manifold pair;
+		auto report = [&](int a, int b)
+		{
+			pair.A = proxies[a].shape;
+			pair.B = proxies[b].shape;
+			pair.contact_count = 0;
+			callback(&pair, data);
+		};
+
+		Sweep(0, (unsigned int)entries.size(), report);
+	}
+
+	void SPC_SweepAndPrune::SweepTask(int task, int /*worker*/, void* data)
+	{
+		SPC_SweepJob* job = reinterpret_cast<SPC_SweepJob*>(data);
+		job->sap->SweepChunk(task, job->chunkCount);
+	}
+
+	void SPC_SweepAndPrune::SweepChunk(int chunk, int chunkCount)
+	{
+		unsigned int n = (unsigned int)entries.size();
+		unsigned int begin = (unsigned int)((long long)n * chunk / chunkCount);
+		unsigned int end = (unsigned int)((long long)n * (chunk + 1) / chunkCount);
+
+		std::vector<int>& out = chunkPairs[chunk];
+		out.clear();
+
+		auto report = [&](int a, int b)
+		{
+			out.push_back(a);
+			out.push_back(b);
+		};
+
+		Sweep(begin, end, report);
+	}
+
+	void SPC_SweepAndPrune::QueryPairs(SPC_PairCallback callback, void* data, SPC_ThreadPool& pool)
+	{
+		Sort();
+
+		int n = (int)entries.size();
+		SPC_SweepJob job = { this, nullptr, n, std::min(pool.GetWorkerCount() * 8, n / MIN_CHUNK_SIZE + 1) };
+
+		if ((int)chunkPairs.size() < job.chunkCount)
+			chunkPairs.resize(job.chunkCount);
+
+		pool.Run(job.chunkCount, SweepTask, &job);
+
+		//report on this thread, in the order of the single threaded sweep
+		SPC_Manifold pair;
+		for (int c = 0; c < job.chunkCount; c++)
+		{
+			std::vector<int>& found = chunkPairs[c];
+			for (unsigned int i = 0; i < found.size(); i += 2)
+			{
+				pair.A = proxies[found[i]].shape;
+				pair.B = proxies[found[i + 1]].shape;
+				pair.contact_count = 0;
+				callback(&pair, data);
+			}
+		}
+	}
+
+	void SPC_SweepAndPrune::Clear()
+	{
+		proxies.clear();
+		entries.clear();
+		freeList = SPC_NULL_PROXY;
+		proxyCount = 0;
+		sorted = true;
+	}
+}
+#endif
\ No newline at end of file
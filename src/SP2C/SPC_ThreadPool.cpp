@@ -0,0 +1,267 @@
+#if !defined(SP2C_SINGLE_TU) || defined(__SPC_UNITY__)
+#include <SP2C/SPC_ThreadPool.h>
+#include <chrono>
+
+namespace SP2C
+{
+	SPC_ThreadPool::SPC_ThreadPool(int threadCount) : queues(threadCount > 0 ? threadCount : std::max(1, (int)std::thread::hardware_concurrency()))
+	{
+		threadCount = (int)queues.size();
+
+		callback = nullptr;
+		data = nullptr;
+		remainingTasks = 0;
+		activeWorkers = 0;
+		generation = 0;
+		stop = false;
+
+		for (auto& queue : queues)
+			queue.head = queue.tail = 0;
+
+		stats.resize(threadCount);
+		ResetStats();
+
+		for (int i = 1; i < threadCount; i++)
+			threads.emplace_back(&SPC_ThreadPool::WorkerLoop, this, i);
+	}
+
+	SPC_ThreadPool::~SPC_ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stop = true;
+		}
+
+		start.notify_all();
+
+		for (auto& thread : threads)
+			thread.join();
+	}
+
+	int SPC_ThreadPool::GetWorkerCount() const
+	{
+		return (int)queues.size();
+	}
+
+	const SPC_WorkerStats& SPC_ThreadPool::GetStats(int worker) const
+	{
+		assert(0 <= worker && worker < (int)stats.size());
+		return stats[worker];
+	}
+
+	SPC_WorkerStats SPC_ThreadPool::GetTotalStats() const
+	{
+		SPC_WorkerStats total = { 0, 0, 0, 0 };
+		for (auto& s : stats)
+		{
+			total.tasks += s.tasks;
+			total.steals += s.steals;
+			total.failedSteals += s.failedSteals;
+			total.idleSeconds += s.idleSeconds;
+		}
+
+		return total;
+	}
+
+	void SPC_ThreadPool::ResetStats()
+	{
+		for (auto& s : stats)
+			s = { 0, 0, 0, 0 };
+	}
+
+	bool SPC_ThreadPool::Pop(int worker, int* task)
+	{
+		SPC_WorkerQueue& queue = queues[worker];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+
+		if (queue.head == queue.tail)
+			return false;
+
+		*task = queue.tasks[queue.head++];
+		return true;
+	}
+
+	bool SPC_ThreadPool::Steal(int worker)
+	{
+		int n = (int)queues.size();
+
+		//pick the queue with the most tasks left. the sizes are only a hint, checked again under the lock
+		int victim = -1, most = 0;
+		for (int k = 1; k < n; k++)
+		{
+			int i = (worker + k) % n;
+			SPC_WorkerQueue& queue = queues[i];
+
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			int size = queue.tail - queue.head;
+			if (size > most)
+			{
+				most = size;
+				victim = i;
+			}
+		}
+
+		if (victim == -1)
+			return false;
+
+		SPC_WorkerQueue& mine = queues[worker];
+		SPC_WorkerQueue& other = queues[victim];
+
+		//lock in index order, so two thieves can't deadlock
+		std::unique_lock<std::mutex> lock1(worker < victim ? mine.mutex : other.mutex);
+		std::unique_lock<std::mutex> lock2(worker < victim ? other.mutex : mine.mutex);
+
+		int size = other.tail - other.head;
+		if (size == 0)
+			return false;
+
+		//take the back half
+		int count = (size + 1) / 2;
+		int begin = other.tail - count;
+
+		if ((int)mine.tasks.size() < count)
+			mine.tasks.resize(count);
+
+		std::copy(other.tasks.begin() + begin, other.tasks.begin() + other.tail, mine.tasks.begin());
+		other.tail = begin;
+		mine.head = 0;
+		mine.tail = count;
+
+		return true;
+	}
+
+	void SPC_ThreadPool::Work(int worker)
+	{
+		SPC_WorkerStats& s = stats[worker];
+		int task;
+
+		//from the first failed steal to the next task or the end of the run. the yields in between count as one failed steal
+		bool idle = false;
+		std::chrono::steady_clock::time_point idleBegin;
+
+		while (true)
+		{
+			if (Pop(worker, &task))
+			{
+				callback(task, worker, data);
+				s.tasks++;
+				remainingTasks.fetch_sub(1);
+				continue;
+			}
+
+			if (remainingTasks.load() == 0)
+				break;
+
+			if (Steal(worker))
+			{
+				s.steals++;
+
+				if (idle)
+				{
+					s.idleSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - idleBegin).count();
+					idle = false;
+				}
+
+				continue;
+			}
+
+			if (!idle)
+			{
+				s.failedSteals++;
+				idleBegin = std::chrono::steady_clock::now();
+				idle = true;
+			}
+
+			std::this_thread::yield();
+		}
+
+		if (idle)
+			s.idleSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - idleBegin).count();
+	}
+
+	void SPC_ThreadPool::WorkerLoop(int worker)
+	{
+		unsigned int seen = 0;
+
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				start.wait(lock, [&] { return stop || generation != seen; });
+
+				if (stop) return;
+				seen = generation;
+				activeWorkers++;
+			}
+
+			Work(worker);
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				activeWorkers--;
+			}
+
+			finish.notify_all();
+		}
+	}
+
+	void SPC_ThreadPool::Run(int taskCount, SPC_TaskCallback callback, void* data, const double* costs)
+	{
+		if (taskCount <= 0) return;
+
+		if (threads.empty() || taskCount == 1) //nothing to share
+		{
+			for (int i = 0; i < taskCount; i++)
+				callback(i, 0, data);
+
+			stats[0].tasks += taskCount;
+			return;
+		}
+
+		{
+			//workers still leaving the last run must not see the new job half written
+			std::unique_lock<std::mutex> lock(mutex);
+			finish.wait(lock, [&] { return activeWorkers == 0; });
+
+			this->callback = callback;
+			this->data = data;
+
+			//contiguous blocks of about the same cost for each worker
+			int n = (int)queues.size();
+			double total = 0;
+			for (int i = 0; i < taskCount; i++)
+				total += costs ? costs[i] : 1;
+
+			int task = 0;
+			double sum = 0;
+
+			for (int w = 0; w < n; w++)
+			{
+				SPC_WorkerQueue& queue = queues[w];
+				if ((int)queue.tasks.size() < taskCount)
+					queue.tasks.resize(taskCount);
+
+				queue.head = queue.tail = 0;
+				double target = total * (w + 1) / n;
+
+				while (task < taskCount && (w == n - 1 || sum < target))
+				{
+					queue.tasks[queue.tail++] = task;
+					sum += costs ? costs[task] : 1;
+					task++;
+				}
+			}
+
+			remainingTasks = taskCount;
+			generation++;
+		}
+
+		start.notify_all();
+
+		Work(0);
+
+		std::unique_lock<std::mutex> lock(mutex);
+		finish.wait(lock, [&] { return remainingTasks.load() == 0 && activeWorkers == 0; });
+	}
+}
+#endif
\ No newline at end of file
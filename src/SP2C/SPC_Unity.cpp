@@ -0,0 +1,20 @@
+//the whole library as one translation unit, so the compiler sees every function from every call without link time optimization.
+//define SP2C_SINGLE_TU and compile this file. the other sources can stay in the project, they compile to nothing with the macro
+#ifdef SP2C_SINGLE_TU
+#define __SPC_UNITY__
+
+#include "SPC_Math.cpp"
+#include "SPC_Shapes.cpp"
+#include "SPC_Manifold.cpp"
+#include "SPC_ThreadPool.cpp"
+#include "SPC_SweepAndPrune.cpp"
+#include "SPC_Collision.cpp"
+#include "SPC_Batch.cpp"
+#include "SPC_DynamicTree.cpp"
+#include "SPC_StaticBVH.cpp"
+#include "SPC_HashGrid.cpp"
+#include "SPC_PairCache.cpp"
+#include "SPC_World.cpp"
+
+#undef __SPC_UNITY__
+#endif
\ No newline at end of file
@@ -0,0 +1,558 @@
+#if !defined(SP2C_SINGLE_TU) || defined(__SPC_UNITY__)
+#include <algorithm>
+#include <SP2C/SPC_World.h>
+#include <SP2C/SPC_Batch.h>
+
+namespace SP2C
+{
+	template <typename T>
+	static inline void SwapRemove(std::vector<T>& v, unsigned int i)
+	{
+		v[i] = v.back();
+		v.pop_back();
+	}
+
+	SPC_World::SPC_World()
+	{
+		freeSlot = INDEX_MASK;
+		garbage = 0;
+	}
+
+	SPC_Handle SPC_World::Allocate(SPC_Shape::ShapeType type, unsigned int index)
+	{
+		unsigned int slot;
+
+		if (freeSlot != INDEX_MASK)
+		{
+			slot = freeSlot;
+			freeSlot = slots[slot].index;
+		}
+		else
+		{
+			slot = (unsigned int)slots.size();
+			assert(slot < INDEX_MASK);
+
+			SPC_WorldSlot s = { SPC_Shape::Count, 0, 0, 0 };
+			slots.push_back(s);
+		}
+
+		slots[slot].type = (unsigned char)type;
+		slots[slot].index = index;
+		slots[slot].sweep = (unsigned int)sweep.size();
+
+		SPC_Handle handle = (unsigned int)slots[slot].generation << INDEX_BITS | slot;
+
+		SweepItem item = { 0, 0, 0, 0, handle };
+		sweep.push_back(item);
+
+		return handle;
+	}
+
+	const SPC_WorldSlot& SPC_World::GetSlot(SPC_Handle handle) const
+	{
+		assert(IsValid(handle));
+		return slots[handle & INDEX_MASK];
+	}
+
+	void SPC_World::SetIndex(SPC_Handle handle, unsigned int index)
+	{
+		slots[handle & INDEX_MASK].index = index;
+	}
+
+	SPC_Handle SPC_World::CreateCircle(Real radius, Vec2 position)
+	{
+		circleX.push_back(position.x);
+		circleY.push_back(position.y);
+		circleRadius.push_back(radius);
+
+		SPC_Handle handle = Allocate(SPC_Shape::Circle, (unsigned int)circleHandle.size());
+		circleHandle.push_back(handle);
+		return handle;
+	}
+
+	SPC_Handle SPC_World::CreateAABB(Vec2 min, Vec2 max)
+	{
+		boxMinX.push_back(min.x);
+		boxMinY.push_back(min.y);
+		boxMaxX.push_back(max.x);
+		boxMaxY.push_back(max.y);
+
+		SPC_Handle handle = Allocate(SPC_Shape::AABB, (unsigned int)boxHandle.size());
+		boxHandle.push_back(handle);
+		return handle;
+	}
+
+	SPC_Handle SPC_World::CreatePolygon(Vec2* v, unsigned int count, bool ordering)
+	{
+		SPC_Polygon polygon;
+		polygon.Set(v, count, ordering);
+
+		return Add(&polygon);
+	}
+
+	SPC_Handle SPC_World::Add(SPC_Shape* shape)
+	{
+		switch (shape->type)
+		{
+		case SPC_Shape::AABB:
+		{
+			SPC_AABB* a = reinterpret_cast<SPC_AABB*>(shape);
+			return CreateAABB(a->min, a->max);
+		}
+
+		case SPC_Shape::Circle:
+		{
+			SPC_Circle* c = reinterpret_cast<SPC_Circle*>(shape);
+			return CreateCircle(c->radius, c->position);
+		}
+
+		default:
+		{
+			SPC_Polygon* p = reinterpret_cast<SPC_Polygon*>(shape);
+
+			polygonStart.push_back((unsigned int)vertices.size());
+			polygonCount.push_back(p->vertexCount);
+			vertices.insert(vertices.end(), p->vertices, p->vertices + p->vertexCount);
+			normals.insert(normals.end(), p->normals, p->normals + p->vertexCount);
+
+			SPC_Handle handle = Allocate(SPC_Shape::Polygon, (unsigned int)polygonHandle.size());
+			polygonHandle.push_back(handle);
+			return handle;
+		}
+		}
+	}
+
+	void SPC_World::Destroy(SPC_Handle handle)
+	{
+		const SPC_WorldSlot& slot = GetSlot(handle);
+		unsigned int i = slot.index;
+
+		switch (slot.type)
+		{
+		case SPC_Shape::AABB:
+			SetIndex(boxHandle.back(), i);
+			SwapRemove(boxMinX, i);
+			SwapRemove(boxMinY, i);
+			SwapRemove(boxMaxX, i);
+			SwapRemove(boxMaxY, i);
+			SwapRemove(boxHandle, i);
+			break;
+
+		case SPC_Shape::Circle:
+			SetIndex(circleHandle.back(), i);
+			SwapRemove(circleX, i);
+			SwapRemove(circleY, i);
+			SwapRemove(circleRadius, i);
+			SwapRemove(circleHandle, i);
+			break;
+
+		default:
+			garbage += polygonCount[i];
+			SetIndex(polygonHandle.back(), i);
+			SwapRemove(polygonStart, i);
+			SwapRemove(polygonCount, i);
+			SwapRemove(polygonHandle, i);
+			break;
+		}
+
+		unsigned int s = handle & INDEX_MASK;
+
+		//the last item takes the place of the removed one. CollideAll sorts it back
+		unsigned int k = slots[s].sweep;
+		slots[sweep.back().handle & INDEX_MASK].sweep = k;
+		SwapRemove(sweep, k);
+
+		slots[s].type = SPC_Shape::Count;
+		slots[s].generation++;
+		slots[s].index = freeSlot;
+		freeSlot = s;
+
+		if (2 * garbage > vertices.size())
+			Compact();
+	}
+
+	bool SPC_World::IsValid(SPC_Handle handle) const
+	{
+		unsigned int s = handle & INDEX_MASK;
+		if (handle == SPC_NULL_HANDLE || s >= slots.size())
+			return false;
+
+		return slots[s].type != SPC_Shape::Count && slots[s].generation == handle >> INDEX_BITS;
+	}
+
+	SPC_Shape::ShapeType SPC_World::GetType(SPC_Handle handle) const
+	{
+		return (SPC_Shape::ShapeType)GetSlot(handle).type;
+	}
+
+	unsigned int SPC_World::GetIndex(SPC_Handle handle) const
+	{
+		return GetSlot(handle).index;
+	}
+
+	void SPC_World::Translate(SPC_Handle handle, Vec2 p)
+	{
+		const SPC_WorldSlot& slot = GetSlot(handle);
+		unsigned int i = slot.index;
+
+		switch (slot.type)
+		{
+		case SPC_Shape::AABB:
+			boxMinX[i] += p.x, boxMinY[i] += p.y;
+			boxMaxX[i] += p.x, boxMaxY[i] += p.y;
+			break;
+
+		case SPC_Shape::Circle:
+			circleX[i] += p.x, circleY[i] += p.y;
+			break;
+
+		default:
+			for (unsigned int k = polygonStart[i]; k < polygonStart[i] + polygonCount[i]; k++)
+				vertices[k] += p;
+			break;
+		}
+	}
+
+	void SPC_World::Scale(SPC_Handle handle, Real k)
+	{
+		const SPC_WorldSlot& slot = GetSlot(handle);
+		unsigned int i = slot.index;
+
+		switch (slot.type)
+		{
+		case SPC_Shape::AABB:
+			boxMinX[i] *= k, boxMinY[i] *= k;
+			boxMaxX[i] *= k, boxMaxY[i] *= k;
+			break;
+
+		case SPC_Shape::Circle:
+			circleRadius[i] *= k;
+			break;
+
+		default:
+			for (unsigned int v = polygonStart[i]; v < polygonStart[i] + polygonCount[i]; v++)
+				vertices[v] = ScaleVec(vertices[v], VEC_ZERO, k);
+			break;
+		}
+	}
+
+	void SPC_World::Rotate(SPC_Handle handle, Real deg)
+	{
+		const SPC_WorldSlot& slot = GetSlot(handle);
+		if (slot.type != SPC_Shape::Polygon)
+			return;
+
+		SPC_Mat23 rotation;
+		rotation.Rotate(deg);
+
+		unsigned int i = slot.index;
+		TransformPoints(rotation, &vertices[polygonStart[i]], polygonCount[i]);
+		TransformVectors(rotation, &normals[polygonStart[i]], polygonCount[i]);
+	}
+
+	void SPC_World::Transform(SPC_Handle handle, const SPC_Mat23& transform)
+	{
+		const SPC_WorldSlot& slot = GetSlot(handle);
+		unsigned int i = slot.index;
+
+		switch (slot.type)
+		{
+		case SPC_Shape::AABB:
+		{
+			Vec2 corners[4];
+			SPC_AABB(Vec2(boxMinX[i], boxMinY[i]), Vec2(boxMaxX[i], boxMaxY[i])).GetVertices(corners);
+			TransformPoints(transform, corners, 4);
+
+			boxMinX[i] = boxMaxX[i] = corners[0].x;
+			boxMinY[i] = boxMaxY[i] = corners[0].y;
+			for (int k = 1; k < 4; k++)
+			{
+				boxMinX[i] = std::min(boxMinX[i], corners[k].x);
+				boxMinY[i] = std::min(boxMinY[i], corners[k].y);
+				boxMaxX[i] = std::max(boxMaxX[i], corners[k].x);
+				boxMaxY[i] = std::max(boxMaxY[i], corners[k].y);
+			}
+			break;
+		}
+
+		case SPC_Shape::Circle:
+		{
+			Vec2 position = transform * Vec2(circleX[i], circleY[i]);
+			circleX[i] = position.x, circleY[i] = position.y;
+			break;
+		}
+
+		default:
+			TransformPoints(transform, &vertices[polygonStart[i]], polygonCount[i]);
+			TransformVectors(transform, &normals[polygonStart[i]], polygonCount[i]);
+			break;
+		}
+	}
+
+	void SPC_World::TransformPolygons(const SPC_Mat23* transforms)
+	{
+		SP2C::TransformPolygons(transforms, polygonStart.data(), polygonCount.data(), (int)polygonStart.size(), vertices.data(), normals.data());
+	}
+
+	SPC_AABB SPC_World::ComputeAABB(SPC_Handle handle) const
+	{
+		const SPC_WorldSlot& slot = GetSlot(handle);
+		unsigned int i = slot.index;
+
+		switch (slot.type)
+		{
+		case SPC_Shape::AABB:
+			return SPC_AABB(Vec2(boxMinX[i], boxMinY[i]), Vec2(boxMaxX[i], boxMaxY[i]));
+
+		case SPC_Shape::Circle:
+			return SPC_AABB(Vec2(circleX[i] - circleRadius[i], circleY[i] - circleRadius[i]), Vec2(circleX[i] + circleRadius[i], circleY[i] + circleRadius[i]));
+
+		default:
+		{
+			Real x1 = REAL_MAX, x2 = -REAL_MAX;
+			Real y1 = REAL_MAX, y2 = -REAL_MAX;
+
+			for (unsigned int v = polygonStart[i]; v < polygonStart[i] + polygonCount[i]; v++)
+			{
+				x1 = std::min(x1, vertices[v].x);
+				x2 = std::max(x2, vertices[v].x);
+				y1 = std::min(y1, vertices[v].y);
+				y2 = std::max(y2, vertices[v].y);
+			}
+
+			return SPC_AABB(Vec2(x1, y1), Vec2(x2, y2));
+		}
+		}
+	}
+
+	SPC_Circle SPC_World::GetCircle(SPC_Handle handle) const
+	{
+		const SPC_WorldSlot& slot = GetSlot(handle);
+		assert(slot.type == SPC_Shape::Circle);
+
+		return SPC_Circle(circleRadius[slot.index], Vec2(circleX[slot.index], circleY[slot.index]));
+	}
+
+	SPC_AABB SPC_World::GetAABB(SPC_Handle handle) const
+	{
+		const SPC_WorldSlot& slot = GetSlot(handle);
+		assert(slot.type == SPC_Shape::AABB);
+
+		return SPC_AABB(Vec2(boxMinX[slot.index], boxMinY[slot.index]), Vec2(boxMaxX[slot.index], boxMaxY[slot.index]));
+	}
+
+	SPC_Polygon SPC_World::GetPolygon(SPC_Handle handle) const
+	{
+		const SPC_WorldSlot& slot = GetSlot(handle);
+		assert(slot.type == SPC_Shape::Polygon);
+
+		SPC_Polygon polygon;
+		unsigned int start = polygonStart[slot.index];
+		polygon.Reserve(polygonCount[slot.index]);
+		polygon.vertexCount = polygonCount[slot.index];
+
+		for (unsigned int i = 0; i < polygon.vertexCount; i++)
+		{
+			polygon.vertices[i] = vertices[start + i];
+			polygon.normals[i] = normals[start + i];
+		}
+
+		return polygon;
+	}
+
+	bool SPC_World::Collide(SPC_Handle a, SPC_Handle b, SPC_Manifold* m) const
+	{
+		return Collide(a, b, m, nullptr);
+	}
+
+	bool SPC_World::Collide(SPC_Handle a, SPC_Handle b, SPC_Manifold* m, SPC_SATCache* cache) const
+	{
+		const SPC_WorldSlot& sa = GetSlot(a);
+		const SPC_WorldSlot& sb = GetSlot(b);
+		unsigned int i = sa.index, j = sb.index;
+
+		m->A = nullptr;
+		m->B = nullptr;
+
+		//pool pointers are only read, the kernels take them as they take the arrays of SPC_Polygon
+		Vec2* v = const_cast<Vec2*>(vertices.data());
+		Vec2* n = const_cast<Vec2*>(normals.data());
+
+		Vec2 corners[4];
+		bool ret;
+
+		switch (sa.type * SPC_Shape::Count + sb.type)
+		{
+		case SPC_Shape::AABB * SPC_Shape::Count + SPC_Shape::AABB:
+			return Collision::AABB_to_AABB(Vec2(boxMinX[i], boxMinY[i]), Vec2(boxMaxX[i], boxMaxY[i]), Vec2(boxMinX[j], boxMinY[j]), Vec2(boxMaxX[j], boxMaxY[j]), m);
+
+		case SPC_Shape::AABB * SPC_Shape::Count + SPC_Shape::Circle:
+			return Collision::AABB_to_Circle(Vec2(boxMinX[i], boxMinY[i]), Vec2(boxMaxX[i], boxMaxY[i]), Vec2(circleX[j], circleY[j]), circleRadius[j], m);
+
+		case SPC_Shape::Circle * SPC_Shape::Count + SPC_Shape::AABB:
+			ret = Collision::AABB_to_Circle(Vec2(boxMinX[j], boxMinY[j]), Vec2(boxMaxX[j], boxMaxY[j]), Vec2(circleX[i], circleY[i]), circleRadius[i], m);
+			Collision::FlipManifold(m);
+			return ret;
+
+		case SPC_Shape::AABB * SPC_Shape::Count + SPC_Shape::Polygon:
+			SPC_AABB(Vec2(boxMinX[i], boxMinY[i]), Vec2(boxMaxX[i], boxMaxY[i])).GetVertices(corners);
+			return Collision::Polygon_to_Polygon(corners, (Vec2*)AABB_normals, 4, v + polygonStart[j], n + polygonStart[j], polygonCount[j], m, cache);
+
+		case SPC_Shape::Polygon * SPC_Shape::Count + SPC_Shape::AABB:
+			SPC_AABB(Vec2(boxMinX[j], boxMinY[j]), Vec2(boxMaxX[j], boxMaxY[j])).GetVertices(corners);
+			ret = Collision::Polygon_to_Polygon(corners, (Vec2*)AABB_normals, 4, v + polygonStart[i], n + polygonStart[i], polygonCount[i], m, cache);
+			Collision::FlipManifold(m);
+			return ret;
+
+		case SPC_Shape::Circle * SPC_Shape::Count + SPC_Shape::Circle:
+			return Collision::Circle_to_Circle(Vec2(circleX[i], circleY[i]), circleRadius[i], Vec2(circleX[j], circleY[j]), circleRadius[j], m);
+
+		case SPC_Shape::Circle * SPC_Shape::Count + SPC_Shape::Polygon:
+			return Collision::Circle_to_Polygon(Vec2(circleX[i], circleY[i]), circleRadius[i], v + polygonStart[j], n + polygonStart[j], polygonCount[j], m);
+
+		case SPC_Shape::Polygon * SPC_Shape::Count + SPC_Shape::Circle:
+			ret = Collision::Circle_to_Polygon(Vec2(circleX[j], circleY[j]), circleRadius[j], v + polygonStart[i], n + polygonStart[i], polygonCount[i], m);
+			Collision::FlipManifold(m);
+			return ret;
+
+		default:
+			return Collision::Polygon_to_Polygon(v + polygonStart[i], n + polygonStart[i], polygonCount[i], v + polygonStart[j], n + polygonStart[j], polygonCount[j], m, cache);
+		}
+	}
+
+	int SPC_World::CollideAll(SPC_WorldContact* out, int capacity)
+	{
+		for (auto& item : sweep)
+		{
+			SPC_AABB aabb = ComputeAABB(item.handle);
+			item.minX = aabb.min.x, item.minY = aabb.min.y;
+			item.maxX = aabb.max.x, item.maxY = aabb.max.y;
+		}
+
+		//by the handle for equal bounds, so std::sort gives the same order as the insertion sort
+		auto before = [](const SweepItem& a, const SweepItem& b)
+		{
+			return a.minX < b.minX || (a.minX == b.minX && a.handle < b.handle);
+		};
+
+		//insertion sort. the order of the last call is almost sorted already
+		unsigned int n = (unsigned int)sweep.size();
+		unsigned int moves = 0, maxMoves = 16 * n;
+
+		for (unsigned int i = 1; i < n; i++)
+		{
+			SweepItem item = sweep[i];
+			unsigned int j = i;
+
+			while (j > 0 && before(item, sweep[j - 1]))
+			{
+				sweep[j] = sweep[j - 1];
+				j--;
+				moves++;
+			}
+
+			sweep[j] = item;
+
+			if (moves > maxMoves) //too far from sorted. insertion sort would be quadratic
+			{
+				std::sort(sweep.begin(), sweep.end(), before);
+				break;
+			}
+		}
+
+		for (unsigned int i = 0; i < n; i++)
+			slots[sweep[i].handle & INDEX_MASK].sweep = i;
+
+		int count = 0;
+		SPC_Manifold m;
+
+		for (unsigned int i = 0; i < n; i++)
+		{
+			const SweepItem& a = sweep[i];
+
+			for (unsigned int j = i + 1; j < n && sweep[j].minX <= a.maxX; j++)
+			{
+				const SweepItem& b = sweep[j];
+				if (a.maxY < b.minY || a.minY > b.maxY)
+					continue;
+
+				if (!Collide(a.handle, b.handle, &m))
+					continue;
+
+				if (count < capacity)
+				{
+					out[count].A = a.handle;
+					out[count].B = b.handle;
+					out[count].manifold = m;
+				}
+
+				count++;
+			}
+		}
+
+		return count;
+	}
+
+	void SPC_World::Compact()
+	{
+		std::vector<Vec2> v, n;
+		v.reserve(vertices.size() - garbage);
+		n.reserve(normals.size() - garbage);
+
+		for (unsigned int i = 0; i < polygonStart.size(); i++)
+		{
+			unsigned int start = polygonStart[i];
+			polygonStart[i] = (unsigned int)v.size();
+
+			v.insert(v.end(), vertices.begin() + start, vertices.begin() + start + polygonCount[i]);
+			n.insert(n.end(), normals.begin() + start, normals.begin() + start + polygonCount[i]);
+		}
+
+		vertices.swap(v);
+		normals.swap(n);
+		garbage = 0;
+	}
+
+	int SPC_World::GetCount() const
+	{
+		return (int)(circleHandle.size() + boxHandle.size() + polygonHandle.size());
+	}
+
+	int SPC_World::GetCount(SPC_Shape::ShapeType type) const
+	{
+		switch (type)
+		{
+		case SPC_Shape::AABB: return (int)boxHandle.size();
+		case SPC_Shape::Circle: return (int)circleHandle.size();
+		case SPC_Shape::Polygon: return (int)polygonHandle.size();
+		default: return 0;
+		}
+	}
+
+	void SPC_World::Clear()
+	{
+		circleX.clear();
+		circleY.clear();
+		circleRadius.clear();
+		circleHandle.clear();
+
+		boxMinX.clear();
+		boxMinY.clear();
+		boxMaxX.clear();
+		boxMaxY.clear();
+		boxHandle.clear();
+
+		polygonStart.clear();
+		polygonCount.clear();
+		polygonHandle.clear();
+
+		vertices.clear();
+		normals.clear();
+
+		slots.clear();
+		sweep.clear();
+		freeSlot = INDEX_MASK;
+		garbage = 0;
+	}
+}
+#endif
\ No newline at end of file
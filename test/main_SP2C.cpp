@@ -2,6 +2,7 @@
 #include <vector>
 #include <SFML/Graphics.hpp>
 #include <map>
+#include <unordered_map>
 
 #include <SP2C/SPC_Shapes.h>
 #include <SP2C/SPC_Collision.h>
@@ -11,11 +12,40 @@ using namespace SP2C;
 using namespace SP2C::Const;
 
 #define ROTATE_POLYGON_TEST 0
+#define COUNT_ALLOCATIONS 0 //heap allocations of the collision part of a frame, shown next to the fps. should stay 0
+
+#if COUNT_ALLOCATIONS
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static atomic<size_t> allocationCount(0); //atomic, so the counter stays right with the pool overload of CollideAll
+
+void* operator new(size_t size)
+{
+	allocationCount++;
+	if (void* p = malloc(size ? size : 1))
+		return p;
+
+	throw bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+	free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+	free(p);
+}
+#endif
 
 struct ShapeTester
 {
 	vector<SPC_Shape*> shapes;
 	bool collided = false;
+	bool ahead = false; //hit by the controlled shape moved ahead
 	Vec2 velocity;
 	int type;
 	double w; //angular velocity for polygon
@@ -33,17 +63,8 @@ SPC_AABB* createBox(double w, double h)
 
 SPC_Polygon* createPolygon(vector<Vec2> v)
 {
-	Vec2 vertices[SPC_Polygon::MAX_POLY];
-
-	int s = 0;
-	for (auto& p : v)
-	{
-		vertices[s++] = p;
-		if (s >= SPC_Polygon::MAX_POLY) break;
-	}
-
 	SPC_Polygon* polygon = new SPC_Polygon;
-	polygon->Set(vertices, s);
+	polygon->Set(v.data(), (unsigned int)v.size());
 	return polygon;
 }
 
@@ -482,37 +503,37 @@ int main()
 		{
 			auto circle = createCircle(rand() % 100 + rand() % 100 * 0.01);
 
-			circle->position = { (double)(rand() % 800), (double)(rand() % 600) };
+			circle->position = { (Real)(rand() % 800), (Real)(rand() % 600) };
 			
 			tester.shapes = { circle };
-			tester.velocity = Vec2((double)(rand() % 100 - 50), (double)(rand() % 100 - 50));
+			tester.velocity = Vec2((Real)(rand() % 100 - 50), (Real)(rand() % 100 - 50));
 			shapes.push_back(tester);
 		}
 		else if (seed == 1) //aabb (box)
 		{
 			auto box = createBox(rand() % 200 + rand() % 100 * 0.01, rand() % 200 + rand() % 100 * 0.01);
-			box->Translate((double)(rand() % 800), (double)(rand() % 600));
+			box->Translate((Real)(rand() % 800), (Real)(rand() % 600));
 			
 			tester.shapes = { box };
-			tester.velocity = Vec2((double)(rand() % 100 - 50), (double)(rand() % 100 - 50));
+			tester.velocity = Vec2((Real)(rand() % 100 - 50), (Real)(rand() % 100 - 50));
 			shapes.push_back(tester);
 		}
 		else if (seed == 2) //polygon (convex)
 		{
 			int count = rand() % 12 + 3; //vertex count
 			vector<Vec2> v;
-			Vec2 pos = { (double)(rand() % 800), (double)(rand() % 600) };
+			Vec2 pos = { (Real)(rand() % 800), (Real)(rand() % 600) };
 
 			for (int i = 0; i < count; i++)
-				v.emplace_back(pos.x + (double)(rand() % 200) - 100, pos.y + (double)(rand() % 200) - 100);
+				v.emplace_back(pos.x + (Real)(rand() % 200) - 100, pos.y + (Real)(rand() % 200) - 100);
 
 			auto polygon = createPolygon(v);
 			
 			tester.shapes = { polygon };
-			tester.velocity = Vec2((double)(rand() % 100 - 50), (double)(rand() % 100 - 50));
+			tester.velocity = Vec2((Real)(rand() % 100 - 50), (Real)(rand() % 100 - 50));
 
 #if ROTATE_POLYGON_TEST
-			tester.w = (double)(rand() % 30 + rand() % 100 * 0.01 - 15);
+			tester.w = (Real)(rand() % 30 + rand() % 100 * 0.01 - 15);
 #endif
 			shapes.push_back(tester);
 		}
@@ -521,7 +542,7 @@ int main()
 			double w = rand() % 200 + rand() % 100 * 0.01, h = rand() % 200 + rand() % 100 * 0.01;
 			int r = (int)(max(w, h) / 2);
 			auto roundrect = createRoundRect(w, h, rand() % r);
-			Vec2 pos = { (double)(rand() % 800), (double)(rand() % 600) };
+			Vec2 pos = { (Real)(rand() % 800), (Real)(rand() % 600) };
 
 			for (auto& s : roundrect)
 				if (s->type == SPC_Shape::AABB)
@@ -530,14 +551,14 @@ int main()
 					reinterpret_cast<SPC_Circle*>(s)->position += pos;
 
 			tester.shapes = roundrect;
-			tester.velocity = Vec2((double)(rand() % 100 - 50), (double)(rand() % 100 - 50));
+			tester.velocity = Vec2((Real)(rand() % 100 - 50), (Real)(rand() % 100 - 50));
 			shapes.push_back(tester);
 		}
 		else if (seed == 4) //polygon (can be concave)
 		{
 			int count = rand() % 12 + 3; //vertex count
 			vector<Vec2> v;
-			Vec2 pos = { (double)(rand() % 800), (double)(rand() % 600) };
+			Vec2 pos = { (Real)(rand() % 800), (Real)(rand() % 600) };
 
 			double angle = 0, theta = 2 * PI / count;
 			for (int i = 0; i < count; i++)
@@ -550,7 +571,7 @@ int main()
 			auto triangles = triangulation(v);
 
 			tester.shapes = { triangles };
-			tester.velocity = Vec2((double)(rand() % 100 - 50), (double)(rand() % 100 - 50));
+			tester.velocity = Vec2((Real)(rand() % 100 - 50), (Real)(rand() % 100 - 50));
 #if ROTATE_POLYGON_TEST
 			tester.w = 0; //pivot should be the center of group, not each centers. didn't implement here.
 #endif
@@ -583,7 +604,17 @@ int main()
 	shapes.push_back(tester);
 	*/
 
-	SPC_Manifold m;
+	vector<SPC_Shape*> world; //every shape of the testers, for the broadphase
+	unordered_map<SPC_Shape*, int> owner; //tester of each shape
+
+	for (int i = 0; i < shapes.size(); i++)
+		for (auto& s : shapes[i].shapes)
+		{
+			world.push_back(s);
+			owner[s] = i;
+		}
+
+	vector<SPC_Manifold> contacts(4096); //preallocated, so a frame doesn't allocate
 
 	sf::RenderWindow window(sf::VideoMode(1024, 768), "SPC Test Window");
 
@@ -601,6 +632,9 @@ int main()
 	double scaleValue = 1;
 	int fpsCount = 0, fps = 0;
 	int keycheck = 0;
+#if COUNT_ALLOCATIONS
+	size_t collisionAllocations = 0; //most in a frame since the last fps update
+#endif
 
 	while (window.isOpen()) //window
 	{
@@ -618,13 +652,18 @@ int main()
 		{
 			fpsTime = 0;
 			fps = fpsCount;
+#if COUNT_ALLOCATIONS
+			fpsCounter.setString("FPS: " + to_string(fps) + "  collision allocations: " + to_string(collisionAllocations));
+			collisionAllocations = 0;
+#else
 			fpsCounter.setString("FPS: " + to_string(fps));
+#endif
 			fpsCount = 0;
 		}
 
 		fpsCount++;
 		for (int i = 0; i < shapes.size(); i++) //reset
-			shapes[i].collided = false;
+			shapes[i].collided = shapes[i].ahead = false;
 
 		window.clear();
 
@@ -640,62 +679,70 @@ int main()
 		//matrix.m[0][0] = scaleValue;
 		//scaleValue -= 0.1 * delta;
 
-		if (sf::Keyboard::isKeyPressed(sf::Keyboard::Up)) shapes[0].shapes[0]->Translate(0, -100 * delta);
-		else if (sf::Keyboard::isKeyPressed(sf::Keyboard::Down)) shapes[0].shapes[0]->Translate(0, 100 * delta);
+		Vec2 move(0, 0);
+
+		if (sf::Keyboard::isKeyPressed(sf::Keyboard::Up)) move.y = -100 * delta;
+		else if (sf::Keyboard::isKeyPressed(sf::Keyboard::Down)) move.y = 100 * delta;
 
-		if (sf::Keyboard::isKeyPressed(sf::Keyboard::Left)) shapes[0].shapes[0]->Translate(-100 * delta, 0);
-		else if (sf::Keyboard::isKeyPressed(sf::Keyboard::Right)) shapes[0].shapes[0]->Translate(100 * delta, 0);
+		if (sf::Keyboard::isKeyPressed(sf::Keyboard::Left)) move.x = -100 * delta;
+		else if (sf::Keyboard::isKeyPressed(sf::Keyboard::Right)) move.x = 100 * delta;
+
+		shapes[0].shapes[0]->Translate(move);
 		
-		for (int i = 0; i < shapes.size(); i++) //collide test
-			for (int j = i + 1; j < shapes.size(); j++)
-			{
-				bool check = false;
-				for (int ii = 0; ii < shapes[i].shapes.size() && !check; ii++)
-				{
-					m.A = shapes[i].shapes[ii]->Clone();
-					//m.A->Transform(matrix);
+#if COUNT_ALLOCATIONS
+		size_t allocationsBefore = allocationCount;
+#endif
+		int hits = Collision::CollideAll(world.data(), world.size(), contacts.data(), contacts.size());
+		hits = min(hits, (int)contacts.size());
 
-					for (int jj = 0; jj < shapes[j].shapes.size() && !check; jj++)
-					{
-						m.B = shapes[j].shapes[jj]->Clone();
-						//m.B->Transform(matrix);
+		//the controlled shape ten frames ahead without moving it. the offset overload collides views of the shapes
+		for (SPC_Shape* other : world)
+		{
+			int j = owner.find(other)->second;
+			if (j == 0) continue;
+
+			SPC_Manifold m;
+			if (Collision::Collide(shapes[0].shapes[0], move * 10, other, Vec2(0, 0), &m))
+				shapes[j].ahead = true;
+		}
+#if COUNT_ALLOCATIONS
+		collisionAllocations = max(collisionAllocations, allocationCount - allocationsBefore);
+#endif
 
-						if (Collision::Collide(&m))
-						{
-							//shapes[i].velocity = Vec2(0, 0);
-							//shapes[j].velocity = Vec2(0, 0);
+		for (int k = 0; k < hits; k++) //collide test
+		{
+			SPC_Manifold& m = contacts[k];
+			int i = owner[m.A], j = owner[m.B];
 
-							shapes[i].collided = shapes[j].collided = true;
-							check = true;
+			if (i == j) //parts of the same roundrect or concave
+				continue;
 
-							/*
-							for (auto& shape : shapes[i].shapes)
-								shape->Translate(-m.normal * m.penetration * delta);
+			//shapes[i].velocity = Vec2(0, 0);
+			//shapes[j].velocity = Vec2(0, 0);
 
-							for (auto& shape : shapes[j].shapes)
-								shape->Translate(m.normal * m.penetration * delta);
-								*/
+			shapes[i].collided = shapes[j].collided = true;
 
-							sf::VertexArray arr(sf::Lines);
-							sf::Vector2f contact = sf::Vector2f(m.contact_points[0].x, m.contact_points[0].y);
-							arr.append(contact);
-							arr.append(contact + sf::Vector2f(m.normal.x * m.penetration, m.normal.y * m.penetration));
-							arr[0].color = sf::Color::Green;
-							arr[1].color = sf::Color::Blue;
+			/*
+			for (auto& shape : shapes[i].shapes)
+				shape->Translate(-m.normal * m.penetration * delta);
 
-							window.draw(arr);
-						}
+			for (auto& shape : shapes[j].shapes)
+				shape->Translate(m.normal * m.penetration * delta);
+				*/
 
-						delete m.B;
-					}
+			sf::VertexArray arr(sf::Lines);
+			sf::Vector2f contact = sf::Vector2f(m.contact_points[0].x, m.contact_points[0].y);
+			arr.append(contact);
+			arr.append(contact + sf::Vector2f(m.normal.x * m.penetration, m.normal.y * m.penetration));
+			arr[0].color = sf::Color::Green;
+			arr[1].color = sf::Color::Blue;
 
-					delete m.A;
-				}
-			}
+			window.draw(arr);
+		}
 		
 		for (auto& test : shapes) //draw shapes
 		{
-			sf::Color color = test.collided ? sf::Color::Red : sf::Color::White;
+			sf::Color color = test.collided ? sf::Color::Red : test.ahead ? sf::Color::Yellow : sf::Color::White;
 
 			auto& shape = test.shapes;
 			if (shape.size() == 1)
@@ -704,11 +751,10 @@ int main()
 				{
 					case SPC_Shape::AABB:
 					{
-						SPC_AABB* a = reinterpret_cast<SPC_AABB*>(shape[0]->Clone());
-						//a->Transform(matrix);
+						const SPC_AABB& a = *static_cast<SPC_AABB*>(shape[0]); //read in place, no copy
 						sf::RectangleShape rect;
-						auto extent = a->GetExtent();
-						auto pos = a->GetCenter();
+						auto extent = a.GetExtent();
+						auto pos = a.GetCenter();
 						rect.setSize(sf::Vector2f(extent.x * 2, extent.y * 2));
 						rect.setOrigin(sf::Vector2f(extent.x, extent.y));
 						rect.setPosition(pos.x, pos.y);
@@ -716,44 +762,36 @@ int main()
 						rect.setOutlineColor(color);
 						rect.setOutlineThickness(1);
 						window.draw(rect);
-
-						delete a;
 						break;
 					}
 
 					case SPC_Shape::Circle:
 					{
-						SPC_Circle* c = reinterpret_cast<SPC_Circle*>(shape[0]->Clone());
-						//c->Transform(matrix);
+						const SPC_Circle& c = *static_cast<SPC_Circle*>(shape[0]);
 						sf::CircleShape circle;
-						circle.setRadius(c->radius);
-						circle.setOrigin(c->radius, c->radius);
-						circle.setPosition(c->position.x, c->position.y);
+						circle.setRadius(c.radius);
+						circle.setOrigin(c.radius, c.radius);
+						circle.setPosition(c.position.x, c.position.y);
 						circle.setFillColor(sf::Color::Transparent);
 						circle.setOutlineColor(color);
 						circle.setOutlineThickness(1);
 						window.draw(circle);
-
-						delete c;
 						break;
 					}
 
 					case SPC_Shape::Polygon:
 					{
-						SPC_Polygon* p = reinterpret_cast<SPC_Polygon*>(shape[0]->Clone());
-						//p->Transform(matrix);
+						const SPC_Polygon& p = *static_cast<SPC_Polygon*>(shape[0]);
 						sf::ConvexShape cv;
-						cv.setPointCount(p->vertexCount);
+						cv.setPointCount(p.vertexCount);
 
-						for (int i = 0; i < p->vertexCount; i++)
-							cv.setPoint(i, sf::Vector2f(p->vertices[i].x, p->vertices[i].y));
+						for (int i = 0; i < p.vertexCount; i++)
+							cv.setPoint(i, sf::Vector2f(p.vertices[i].x, p.vertices[i].y));
 
 						cv.setFillColor(sf::Color::Transparent);
 						cv.setOutlineColor(color);
 						cv.setOutlineThickness(1);
 						window.draw(cv);
-
-						delete p;
 						break;
 					}
 
@@ -787,12 +825,14 @@ int main()
 
 				case SPC_Shape::Polygon:
 				{
-					auto polygon = reinterpret_cast<SPC_Polygon*>(s);
-					polygon->Translate(shape.velocity.x * delta, shape.velocity.y * delta);
+					//one transform for the vertices and normals, instead of Translate and Rotate one after another
+					SPC_Mat23 move;
+					move.Translate(shape.velocity * delta);
 
 #if ROTATE_POLYGON_TEST
-					polygon->Rotate(shape.w * delta);
+					move.Rotate(shape.w * delta);
 #endif
+					reinterpret_cast<SPC_Polygon*>(s)->Transform(move);
 					break;
 				}
 